@@ -30,6 +30,11 @@ show_help() {
     echo "  -z, --zip           Create ZIP packages after build"
     echo "  -w, --windows       Cross-compile for Windows"
     echo "  --no-discord        Build without Discord RPC support"
+    echo "  --alloc-tracking    Track heap allocations per frame"
+    echo "  --sampling-profiler Build the sampling CPU profiler (Linux only)"
+    echo "  --hot-reload        Reload changed assets while running (Linux only)"
+    echo "  --lto               Enable link time optimization"
+    echo "  --pgo [FRAMES]      Profile guided + LTO build trained on the headless benchmark"
 }
 
 BUILD_TYPE="Release"
@@ -38,6 +43,13 @@ JOBS=$(nproc 2>/dev/null || echo 1)
 CREATE_ZIP=false
 WINDOWS_BUILD=false
 DISCORD_SUPPORT=true
+ALLOC_TRACKING=false
+SAMPLING_PROFILER=false
+HOT_RELOAD=false
+LTO=false
+PGO_BUILD=false
+PGO_FRAMES=3600
+EXTRA_CMAKE_ARGS=()
 BUILD_DIR="build"
 
 # arg parsing
@@ -73,6 +85,31 @@ while [[ $# -gt 0 ]]; do
             DISCORD_SUPPORT=false
             shift
             ;;
+        --alloc-tracking)
+            ALLOC_TRACKING=true
+            shift
+            ;;
+        --sampling-profiler)
+            SAMPLING_PROFILER=true
+            shift
+            ;;
+        --hot-reload)
+            HOT_RELOAD=true
+            shift
+            ;;
+        --lto)
+            LTO=true
+            shift
+            ;;
+        --pgo)
+            PGO_BUILD=true
+            BUILD_DIR="build_pgo"
+            if [[ "$2" =~ ^[0-9]+$ ]]; then
+                PGO_FRAMES="$2"
+                shift
+            fi
+            shift
+            ;;
         *)
             log_error "Unknown option: $1"
             show_help
@@ -135,6 +172,24 @@ build_project() {
         cmake_args+=("-DDISCORD_RPC=ON")
     fi
 
+    if [[ "$ALLOC_TRACKING" == true ]]; then
+        cmake_args+=("-DALLOC_TRACKING=ON")
+    fi
+
+    if [[ "$SAMPLING_PROFILER" == true ]]; then
+        cmake_args+=("-DSAMPLING_PROFILER=ON")
+    fi
+
+    if [[ "$HOT_RELOAD" == true ]]; then
+        cmake_args+=("-DHOT_RELOAD=ON")
+    fi
+
+    if [[ "$LTO" == true ]]; then
+        cmake_args+=("-DLTO=ON")
+    fi
+
+    cmake_args+=("${EXTRA_CMAKE_ARGS[@]}")
+
     if [[ "$WINDOWS_BUILD" == true ]]; then
         cmake_args+=("-DCMAKE_TOOLCHAIN_FILE=../cmake/mingw-toolchain.cmake")
     fi
@@ -168,6 +223,53 @@ build_project() {
     fi
 }
 
+# runs the headless benchmark and prints its mean frame time in ms
+run_benchmark() {
+    local log="$BUILD_DIR/benchmark_$1.log"
+    local runner=()
+
+    # the benchmark opens a hidden window, so it still needs a display
+    if [[ -z "$DISPLAY" && -z "$WAYLAND_DISPLAY" ]] && is_command_available xvfb-run; then
+        runner=(xvfb-run -a)
+    fi
+
+    log_info "Running the benchmark ($1, $PGO_FRAMES frames)..." >&2
+    "${runner[@]}" ./bombkurdistan --benchmark "$PGO_FRAMES" > "$log" 2>&1 || {
+        log_error "Benchmark failed, see $log"
+        exit 1
+    }
+    grep -o 'mean_ms=[0-9.]*' "$log" | cut -d= -f2
+}
+
+# baseline release build, instrumented build + training run, then the PGO + LTO build
+pgo_build() {
+    local profile_dir="$PWD/$BUILD_DIR/profiles"
+
+    EXTRA_CMAKE_ARGS=("-DPGO_MODE=" "-DLTO=OFF")
+    build_project
+    CLEAN_BUILD=false # the next stages reuse the build directory and keep the profiles
+    local baseline
+    baseline=$(run_benchmark baseline)
+
+    rm -rf "$profile_dir"
+    EXTRA_CMAKE_ARGS=("-DPGO_MODE=GENERATE" "-DPGO_PROFILE_DIR=$profile_dir")
+    build_project
+    run_benchmark training > /dev/null
+
+    if ls "$profile_dir"/*.profraw >/dev/null 2>&1; then
+        # clang writes raw profiles that have to be merged
+        llvm-profdata merge -o "$profile_dir/merged.profdata" "$profile_dir"/*.profraw
+    fi
+
+    EXTRA_CMAKE_ARGS=("-DPGO_MODE=USE" "-DPGO_PROFILE_DIR=$profile_dir")
+    build_project
+    local optimized
+    optimized=$(run_benchmark optimized)
+
+    log_success "Baseline: $baseline ms/frame, PGO + LTO: $optimized ms/frame"
+    log_success "Speedup: $(awk -v a="$baseline" -v b="$optimized" 'BEGIN { printf "%.2fx", a / b }')"
+}
+
 # zipping
 zip_packages() {
     if [[ "$CREATE_ZIP" == false ]]; then
@@ -185,7 +287,15 @@ zip_packages() {
 
 main() {
     check_dependencies
-    build_project
+    if [[ "$PGO_BUILD" == true ]]; then
+        if [[ "$WINDOWS_BUILD" == true || "$BUILD_TYPE" == "Debug" ]]; then
+            log_error "--pgo needs a native release build"
+            exit 1
+        fi
+        pgo_build
+    else
+        build_project
+    fi
     zip_packages
 
     log_success "All done!"
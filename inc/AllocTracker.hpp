@@ -0,0 +1,65 @@
+#pragma once
+#ifndef ALLOCTRACKER_HPP
+#define ALLOCTRACKER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// subsystem an allocation is attributed to, set with ALLOC_SCOPE
+enum class AllocTag : uint8_t { OTHER, ATTACKS, BOMBS, TEXT, AUDIO, COUNT };
+
+#ifdef ALLOC_TRACKING
+
+// opt-in (ALLOC_TRACKING build option) counter of every global new/delete and raylib
+// RL_MALLOC call, attributed per frame and per subsystem tag
+class AllocTracker
+{
+public:
+    struct Stats
+    {
+        uint32_t allocations;
+        uint64_t bytes;
+    };
+
+    static void setBudget(uint32_t allocationsPerFrame);
+    static void endFrame(bool checkBudget);
+    static void drawOverlay();
+    [[nodiscard]] static bool budgetExceeded() { return exceededFrames > 0; }
+
+    // called from the allocation hooks, must never allocate itself
+    static void record(size_t size, bool fromRaylib);
+    static void recordFree();
+    static AllocTag swapTag(AllocTag tag);
+
+private:
+    static Stats lastFrame[static_cast<size_t>(AllocTag::COUNT)];
+    static Stats peakFrame;
+    static uint32_t lastFrameRaylib;
+    static uint32_t lastFrameFrees;
+    static uint32_t budget; // 0 means no budget
+    static uint32_t exceededFrames;
+    static uint64_t frameIndex;
+};
+
+class AllocScope
+{
+public:
+    explicit AllocScope(AllocTag tag) : previous(AllocTracker::swapTag(tag)) {}
+    ~AllocScope() { AllocTracker::swapTag(previous); }
+
+    AllocScope(const AllocScope &) = delete;
+    AllocScope &operator=(const AllocScope &) = delete;
+
+private:
+    AllocTag previous;
+};
+
+#define ALLOC_SCOPE(tag) const AllocScope allocScope(AllocTag::tag)
+
+#else
+
+#define ALLOC_SCOPE(tag)
+
+#endif // ALLOC_TRACKING
+
+#endif // ALLOCTRACKER_HPP
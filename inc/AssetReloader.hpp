@@ -0,0 +1,62 @@
+#pragma once
+#ifndef ASSETRELOADER_HPP
+#define ASSETRELOADER_HPP
+
+#ifdef HOT_RELOAD
+
+#include "raylib.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// development only (HOT_RELOAD build option, linux only): watches the assets directory
+// with inotify, re-decodes changed files on a background thread and swaps them into the
+// live Texture2D/Music handles at a frame boundary, everything holding a reference to
+// those handles picks the new asset up
+class AssetReloader
+{
+public:
+    // handles must stay at the same address while watched
+    static void watchTexture(const char *path, Texture2D *texture);
+    static void watchMusic(const char *path, Music *music);
+    static void start(const char *directory);
+    // stops watching and forgets every handle
+    static void stop();
+    // main thread only, never waits for the watcher thread
+    static void apply();
+
+private:
+    struct Watched
+    {
+        std::string fileName; // without the directory
+        Texture2D *texture;
+        Music *music;
+        unsigned char *musicData; // streamed from memory, freed when replaced
+    };
+
+    struct Reload
+    {
+        size_t index;
+        Image image;
+        unsigned char *data;
+        int dataSize;
+    };
+
+    static std::vector<Watched> watched;
+    static std::vector<Reload> pending; // guarded by pendingMutex
+    static std::mutex pendingMutex;
+    static std::thread worker;
+    static std::atomic<bool> running;
+    static std::string directory;
+
+    static void watch(const std::string &path);
+    static void load(size_t index);
+    static void freeReload(Reload &reload);
+};
+
+#endif // HOT_RELOAD
+
+#endif // ASSETRELOADER_HPP
@@ -0,0 +1,74 @@
+#pragma once
+#ifndef ATTACKPATTERNS_HPP
+#define ATTACKPATTERNS_HPP
+
+#include "AttackTables.hpp"
+#include "raylib.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define ATTACK_PATTERNS_PATH "assets/patterns.txt"
+
+// one emission step of a pattern, waves of a pattern are sorted by time
+struct PatternWave
+{
+    float time;       // seconds after the attack exploded
+    float speedScale; // multiplier on the size's bullet speed
+    uint16_t firstDirection;
+    uint16_t bulletCount;
+    uint8_t aimed; // 1 if the directions are relative to the player direction
+};
+
+struct AttackPattern
+{
+    uint16_t firstWave;
+    uint16_t waveCount;
+    float weight; // relative chance among the patterns of the same size
+};
+
+// boss attack patterns are described in a text file and compiled once at load
+// into flat tables, BossAttack just walks the waves of its pattern every tick
+class AttackPatterns
+{
+public:
+    static void load(const char *path);
+    static uint16_t pick(AttackSize size);
+
+    static const AttackPattern &pattern(uint16_t index) { return patterns[index]; }
+    static const PatternWave *waves() { return waveTable.data(); }
+    static const Vector2 *directions() { return directionTable.data(); }
+
+private:
+    struct Definition
+    {
+        std::string name;
+        int line;
+        AttackSize size;
+        bool hasSize;
+        bool aimed;
+        int bullets; // 0 means the size's default bullet count
+        int waves;
+        float interval;
+        float rotate; // degrees
+        float spread; // degrees, aimed only
+        float speed;
+        float weight;
+    };
+
+    static std::vector<AttackPattern> patterns;
+    static std::vector<PatternWave> waveTable;
+    static std::vector<Vector2> directionTable;
+    static std::vector<uint16_t> patternsBySize[AttackTables::SIZE_COUNT];
+    static float totalWeight[AttackTables::SIZE_COUNT];
+
+    static void clear();
+    static bool setKey(Definition &definition, const std::string &key, const std::string &value);
+    static bool validate(const Definition &definition);
+    static void compile(const Definition &definition);
+    static void addPattern(AttackSize size, const AttackPattern &pattern);
+    static void addDefaultRing(AttackSize size);
+};
+
+#endif // ATTACKPATTERNS_HPP
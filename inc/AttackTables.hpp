@@ -0,0 +1,96 @@
+#pragma once
+#ifndef ATTACKTABLES_HPP
+#define ATTACKTABLES_HPP
+
+#include "Constants.hpp"
+#include "Difficulty.hpp"
+#include "raylib.h"
+
+#include <array>
+#include <cstddef>
+
+enum class AttackSize { SMALL, MEDIUM, LARGE };
+
+// everything BossAttack needs is resolved at compile time into the tables below,
+// so the hot paths are plain indexed loads instead of nested ternaries
+namespace AttackTables {
+constexpr size_t DIFFICULTY_COUNT = std::size(BossAttackConfig::DIFFICULTY_FACTOR);
+constexpr size_t SIZE_COUNT = std::size(BossAttackConfig::EXPLODE_TIME);
+
+struct AttackParams
+{
+    float explodeDelay; // seconds from spawn to explosion, difficulty factor applied
+    float bulletSpeed;  // difficulty factor applied
+    int bulletCount;
+    float radius;
+    Color color;
+    const Vector2 *directions; // bulletCount unit vectors, evenly spread on a ring
+};
+
+namespace detail {
+constexpr double PI_D = 3.14159265358979323846;
+
+// std::sin/std::cos are not constexpr yet, a taylor series is exact enough for floats
+constexpr double sinTaylor(double x)
+{
+    while (x > PI_D)
+        x -= 2 * PI_D;
+    while (x < -PI_D)
+        x += 2 * PI_D;
+
+    double term = x;
+    double sum = x;
+    for (int i = 1; i < 12; ++i) {
+        term *= -x * x / ((2 * i) * (2 * i + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+template <int Count> constexpr std::array<Vector2, Count> ringDirections()
+{
+    std::array<Vector2, Count> dirs{};
+    for (int i = 0; i < Count; ++i) {
+        const double angle = 2 * PI_D * i / Count;
+        dirs[i] = {static_cast<float>(sinTaylor(angle + PI_D / 2)),
+                   static_cast<float>(sinTaylor(angle))};
+    }
+    return dirs;
+}
+
+constexpr auto SMALL_DIRECTIONS = ringDirections<BossAttackConfig::BULLET_COUNT[0]>();
+constexpr auto MEDIUM_DIRECTIONS = ringDirections<BossAttackConfig::BULLET_COUNT[1]>();
+constexpr auto LARGE_DIRECTIONS = ringDirections<BossAttackConfig::BULLET_COUNT[2]>();
+
+constexpr const Vector2 *DIRECTIONS[] = {SMALL_DIRECTIONS.data(), MEDIUM_DIRECTIONS.data(),
+                                         LARGE_DIRECTIONS.data()};
+constexpr Color COLORS[] = {RED, YELLOW, BLUE};
+
+constexpr std::array<std::array<AttackParams, SIZE_COUNT>, DIFFICULTY_COUNT> buildParams()
+{
+    std::array<std::array<AttackParams, SIZE_COUNT>, DIFFICULTY_COUNT> table{};
+    for (size_t d = 0; d < DIFFICULTY_COUNT; ++d) {
+        const float factor = BossAttackConfig::DIFFICULTY_FACTOR[d];
+        for (size_t s = 0; s < SIZE_COUNT; ++s) {
+            table[d][s] = {.explodeDelay = BossAttackConfig::EXPLODE_TIME[s] * factor,
+                           .bulletSpeed = BossAttackConfig::BULLET_SPEED[s] * factor,
+                           .bulletCount = BossAttackConfig::BULLET_COUNT[s],
+                           .radius = BossAttackConfig::ATTACK_RADIUS[s],
+                           .color = COLORS[s],
+                           .directions = DIRECTIONS[s]};
+        }
+    }
+    return table;
+}
+} // namespace detail
+
+constexpr auto PARAMS = detail::buildParams();
+
+// looked up once when an attack starts, the update itself never branches on difficulty
+inline const AttackParams &params(Difficulty difficulty, AttackSize size)
+{
+    return PARAMS[static_cast<size_t>(difficulty)][static_cast<size_t>(size)];
+}
+} // namespace AttackTables
+
+#endif // ATTACKTABLES_HPP
@@ -0,0 +1,41 @@
+#pragma once
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include "Constants.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#define BENCHMARK_DEFAULT_FRAMES 3600 // one minute of gameplay
+#define BENCHMARK_SEED 1337
+
+class Game;
+
+// headless scripted workload (--benchmark N): a hidden window without vsync plays N frames
+// with a fixed time step, a fixed seed and a bot moving the player, then prints the frame
+// times. used to train and measure the PGO build, see build.sh --pgo
+class Benchmark
+{
+public:
+    static constexpr float FRAME_TIME = 1.f / DEFAULT_GAME_FPS;
+
+    static void start(int frames);
+    [[nodiscard]] static bool isRunning() { return frameLimit > 0; }
+
+    // keeps the game in PLAYING and steers the player, called before the frame
+    static void beginFrame(Game &game);
+    // records the frame time and closes the game after the last frame
+    static void endFrame(Game &game);
+
+private:
+    static int frameLimit;
+    static std::vector<float> frameTimes; // milliseconds
+    static std::chrono::steady_clock::time_point frameStart;
+    static uint32_t runs;
+
+    static void report();
+};
+
+#endif // BENCHMARK_HPP
@@ -4,24 +4,35 @@
 
 #include "Boss.hpp"
 #include "Player.hpp"
+#include "StateBuffer.hpp"
+#include "TimerWheel.hpp"
 #include "raylib.h"
 
 class Bomb
 {
 public:
     Bomb(const Texture2D &texture, Vector2 position);
+    Bomb(const Texture2D &texture, StateReader &reader);
 
     Vector2 position;
 
+    void init(Vector2 newPosition);
     void draw() const;
-    void update(const Player &player, Boss &boss, float deltaTime);
+    // either player picks it up, partner is only set in co-op
+    void update(const Player &player, const Player *partner, Boss &boss, float deltaTime);
     [[nodiscard]] bool isAlive() const;
     void explode(Boss &boss);
+    void save(StateWriter &writer) const;
+    // takes the place of init() for a bomb of a saved state
+    void load(StateReader &reader);
 
 private:
-    Texture2D texture;
-    float expireTime;
+    const Texture2D &texture; // owned by Game
+    bool alive;
+    TimerId expireTimer; // cleared by the wheel when the bomb was not picked up in time
     float currentScale;
+
+    static void onExpireTimer(void *self);
 };
 
 #endif // BOMB_HPP
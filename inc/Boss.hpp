@@ -2,23 +2,33 @@
 #ifndef BOSS_HPP
 #define BOSS_HPP
 
+#include "StateBuffer.hpp"
 #include "raylib.h"
 
+// driven by Game::bossPhaseScript from the boss health
+enum class BossPhase { CALM, ANGRY, ENRAGED };
+
 class Boss
 {
 public:
     Boss(const Texture2D &texture, const Texture2D &lareiTexture);
 
     float health{};
+    BossPhase phase = BossPhase::CALM;
 
     void draw() const;
     void update(float deltaTime);
     void init();
     void takeDamage(float damage);
+    void setPhase(BossPhase newPhase);
+    void save(StateWriter &writer) const;
+    void load(StateReader &reader);
+    [[nodiscard]] BossPhase phaseForHealth() const;
 
 private:
-    Texture2D texture;
-    Texture2D lareiTexture;
+    // owned by Game
+    const Texture2D &texture;
+    const Texture2D &lareiTexture;
     float animTime;
     float lareiOffsetX;
 };
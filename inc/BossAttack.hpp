@@ -2,29 +2,50 @@
 #ifndef BOSSATTACK_HPP
 #define BOSSATTACK_HPP
 
+#include "AttackTables.hpp"
 #include "Bullet.hpp"
+#include "HitPredictor.hpp"
 #include "Player.hpp"
+#include "StateBuffer.hpp"
+#include "TimerWheel.hpp"
 #include "raylib.h"
-#include <memory>
+#include <cstdint>
 #include <vector>
 
-enum class AttackSize { SMALL, MEDIUM, LARGE };
-
 class BossAttack
 {
 public:
     BossAttack(Vector2 position, AttackSize size);
+    explicit BossAttack(StateReader &reader);
 
     Vector2 position;
     AttackSize size;
     float explodeTime;
     bool exploded;
-    std::vector<std::unique_ptr<Bullet>> bullets;
+    std::vector<Bullet> bullets;
 
+    void init(Vector2 newPosition, AttackSize newSize);
     void draw() const;
-    void update(Player &player);
+    // partner is the second player of a co-op game, a downed player can't be hit
+    void update(Player &player, Player *partner);
     [[nodiscard]] bool isAlive() const;
     void explode();
+    void save(StateWriter &writer) const;
+    // takes the place of init() for an attack of a saved state
+    void load(StateReader &reader);
+
+private:
+    const AttackTables::AttackParams *params; // resolved once for the spawn difficulty
+    uint16_t nextWave; // index into the pattern wave table
+    uint16_t waveEnd;
+    uint16_t bulletRepeat; // rotated copies of every wave, more than 1 only in survival
+    std::vector<PredictedHit> predictedHits; // min heap, only used with hit prediction
+    float bulletsExpireTime;
+    TimerId explodeTimer;
+
+    void emitWaves(Vector2 target);
+    void updatePredicted(Player &player);
+    static void onExplodeTimer(void *self);
 };
 
 #endif // BOSSATTACK_HPP
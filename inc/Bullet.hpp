@@ -2,22 +2,33 @@
 #ifndef BULLET_HPP
 #define BULLET_HPP
 
+#include "StateBuffer.hpp"
 #include "raylib.h"
 
 class Bullet
 {
 public:
+    Bullet() = default; // for restoring saved bullets, see load()
     Bullet(Vector2 position, Vector2 direction, float speed);
 
     bool active;
     Vector2 position;
+    float spawnTime;
+    float expireTime; // when the bullet leaves the screen
 
     void update(float deltaTime);
     void draw() const;
+    [[nodiscard]] Vector2 positionAt(float time) const;
+    [[nodiscard]] Vector2 getVelocity() const;
+    // only active bullets are saved, load() takes the place of the constructor
+    void save(StateWriter &writer) const;
+    void load(StateReader &reader);
 
 private:
-    Vector2 direction;
     Vector2 velocity{};
+    Vector2 spawnPosition;
+
+    void updateExpireTime();
 };
 
 #endif // BULLET_HPP
@@ -0,0 +1,24 @@
+#pragma once
+#ifndef COLLISION_HPP
+#define COLLISION_HPP
+
+#include "raylib.h"
+
+// swept circle test: both circles move linearly during the same step, a from a0 to a1 and
+// b from b0 to b1. returns true if their distance drops to radius (sum of both radii) at
+// any point of the step, so fast circles can't tunnel through each other on long frames
+inline bool checkSweptCircles(Vector2 a0, Vector2 a1, Vector2 b0, Vector2 b1, float radius)
+{
+    // relative motion of a as seen from b
+    const Vector2 d = {a0.x - b0.x, a0.y - b0.y};
+    const Vector2 v = {(a1.x - a0.x) - (b1.x - b0.x), (a1.y - a0.y) - (b1.y - b0.y)};
+
+    const float vv = v.x * v.x + v.y * v.y;
+    float t = vv > 0.f ? -(d.x * v.x + d.y * v.y) / vv : 0.f;
+    t = t < 0.f ? 0.f : (t > 1.f ? 1.f : t); // closest approach within the step
+
+    const Vector2 closest = {d.x + v.x * t, d.y + v.y * t};
+    return closest.x * closest.x + closest.y * closest.y <= radius * radius;
+}
+
+#endif // COLLISION_HPP
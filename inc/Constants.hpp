@@ -2,6 +2,9 @@
 #ifndef CONSTANTS_HPP
 #define CONSTANTS_HPP
 
+#include <cstddef>
+#include <cstdint>
+
 #define TEXT_HEIGHT 25.f
 #define DEFAULT_GAME_FPS 60
 
@@ -24,26 +27,26 @@
 #define PLAYER_COLLISION_RADIUS 16.f
 #define PLAYER_SPEED (DEFAULT_GAME_FPS * 5)
 
+// replay playback, the seeks are in seconds of game time
+#define REPLAY_FAST_FORWARD 8
+#define REPLAY_SEEK_BACK 10.f
+#define REPLAY_SEEK_AHEAD 30.f
+
 #define SCREEN_DRAW_X (SCREEN_WIDTH / 2.f)
 #define SCREEN_DRAW_Y (SCREEN_HEIGHT / 2.f)
 #define DARKRED (Color){139, 0, 0, 255}
 
 namespace BossAttackConfig {
-constexpr float EASY_FACTOR = 0.8f;
-constexpr float NORMAL_FACTOR = 1.0f;
-constexpr float HARD_FACTOR = 1.5f;
-
-constexpr float SMALL_EXPLODE_TIME = 0.5f;
-constexpr float MEDIUM_EXPLODE_TIME = 1.0f;
-constexpr float LARGE_EXPLODE_TIME = 1.5f;
-
-constexpr int SMALL_BULLET_COUNT = 8;
-constexpr int MEDIUM_BULLET_COUNT = 10;
-constexpr int LARGE_BULLET_COUNT = 12;
-
-constexpr int SMALL_BULLET_SPEED = 6;
-constexpr int MEDIUM_BULLET_SPEED = 4;
-constexpr int LARGE_BULLET_SPEED = 3;
+// indexed by Difficulty (EASY, NORMAL, HARD)
+constexpr float DIFFICULTY_FACTOR[] = {0.8f, 1.0f, 1.5f};
+constexpr int MAX_ATTACKS_PER_SPAWN[] = {2, 3, 5};
+constexpr size_t MAX_ALIVE_ATTACKS[] = {3, 3, SIZE_MAX}; // no limit on HARD
+
+// indexed by AttackSize (SMALL, MEDIUM, LARGE)
+constexpr float EXPLODE_TIME[] = {0.5f, 1.0f, 1.5f};
+constexpr int BULLET_COUNT[] = {8, 10, 12};
+constexpr int BULLET_SPEED[] = {6, 4, 3};
+constexpr float ATTACK_RADIUS[] = {25.f, 30.f, 50.f};
 } // namespace BossAttackConfig
 
 #endif
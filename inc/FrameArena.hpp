@@ -0,0 +1,53 @@
+#pragma once
+#ifndef FRAMEARENA_HPP
+#define FRAMEARENA_HPP
+
+#include <cstddef>
+#include <vector>
+
+// bump allocator for data that only lives during one frame, everything allocated from it
+// is released at once by reset() at the end of Game::updateFrame
+class FrameArena
+{
+public:
+    static constexpr size_t CAPACITY = 64 * 1024;
+
+    static void *allocate(size_t size, size_t alignment);
+    static void deallocate(void *ptr, size_t size, size_t alignment);
+    static void reset();
+    [[nodiscard]] static size_t used() { return offset; }
+    [[nodiscard]] static size_t peak() { return peakOffset; }
+
+private:
+    alignas(std::max_align_t) static unsigned char buffer[CAPACITY];
+    static size_t offset;
+    static size_t peakOffset;
+    static size_t overflowCount; // allocations that did not fit this frame
+
+    static bool owns(const void *ptr);
+};
+
+// STL allocator adapter, containers using it must not outlive the frame
+template <typename T> struct ArenaAllocator
+{
+    using value_type = T;
+
+    ArenaAllocator() = default;
+    template <typename U> ArenaAllocator(const ArenaAllocator<U> &) noexcept {}
+
+    T *allocate(size_t n)
+    {
+        return static_cast<T *>(FrameArena::allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *ptr, size_t n) noexcept
+    {
+        FrameArena::deallocate(ptr, n * sizeof(T), alignof(T));
+    }
+
+    template <typename U> bool operator==(const ArenaAllocator<U> &) const noexcept { return true; }
+};
+
+template <typename T> using FrameVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif // FRAMEARENA_HPP
@@ -0,0 +1,98 @@
+#pragma once
+#ifndef FRAMECAPTURE_HPP
+#define FRAMECAPTURE_HPP
+
+#include "raylib.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define CAPTURE_DIR "captures"
+#define CAPTURE_DEFAULT_FPS 60
+
+// records the game into a video while it's played (F10 or --capture). every frame is
+// copied at SCREEN_WIDTH x SCREEN_HEIGHT and read back through a ring of pixel pack buffers,
+// mapped a few frames later when the GPU is long done, so presenting never waits on it. a
+// worker thread converts and writes them:
+//
+//   name.y4m    YUV 4:2:0 Y4M, plays and converts everywhere
+//   other       raw RGBA frames
+//   |command    Y4M into the stdin of an encoder, e.g. "|ffmpeg -i - clip.mp4"
+//
+// when the worker falls behind the frames are dropped, the game loop never waits. the
+// drops are shown while recording and logged at the end
+class FrameCapture
+{
+public:
+    // needs the GL context, false when the output can't be opened or the driver lacks
+    // pixel buffers
+    static bool start(const std::string &output, int fps);
+    // reads back the frames still in flight and returns, writing them and closing the
+    // output happen in the background
+    static void stop();
+    // stops and waits until every output is closed, before exiting
+    static void shutdown();
+    [[nodiscard]] static bool isCapturing() { return capturing; }
+    [[nodiscard]] static int fps() { return framesPerSecond; }
+    // a new file in CAPTURE_DIR named after the current time
+    [[nodiscard]] static std::string defaultPath();
+
+    // called with the finished frame before it's presented, takes one frame per 1/fps
+    static void capture(const Texture2D &frame);
+    // on top of the window, so it's not part of the video
+    static void drawIndicator();
+
+private:
+    static constexpr size_t PBO_COUNT = 3;
+    static constexpr size_t QUEUE_FRAMES = 8; // frames waiting for the worker
+
+    enum class Format { Y4M, RAW };
+
+    static bool capturing;
+    static Format format;
+    static FILE *output;
+    static bool isPipe;
+    static int framesPerSecond;
+    static float captureClock; // real time not captured yet
+    static float elapsed;
+    static RenderTexture2D copy; // the frame at 1x, the size stays put when the scale changes
+
+    static std::array<unsigned int, PBO_COUNT> pbos;
+    static std::array<void *, PBO_COUNT> fences; // GLsync, null when the buffer is unused
+    static size_t nextPbo;
+
+    // the queue of the worker, frames move between the free and the ready ring
+    static std::array<std::vector<uint8_t>, QUEUE_FRAMES> frames;
+    static std::array<size_t, QUEUE_FRAMES> freeFrames;
+    static size_t freeCount;
+    static std::array<size_t, QUEUE_FRAMES> readyFrames;
+    static size_t readyFirst;
+    static size_t readyCount;
+    static bool stopping; // set by stop(), the worker drains the queue and hands off the output
+    static std::mutex mutex;
+    static std::condition_variable wake;
+    static std::thread worker;
+    static std::vector<std::future<void>> closing; // outputs of finished recordings
+
+    static uint32_t captured;
+    static uint32_t dropped;
+    static std::atomic<uint32_t> written;
+    static std::atomic<bool> failed; // the output stopped taking data
+
+    // maps the oldest readback and queues it, or counts it as dropped
+    static void collect(size_t pbo, bool wait);
+    static void work();
+    static void closeOutput(FILE *file, bool pipe, uint32_t frames, uint32_t lost,
+                            uint32_t total);
+    static bool writeFrame(const std::vector<uint8_t> &rgba, std::vector<uint8_t> &yuv);
+};
+
+#endif // FRAMECAPTURE_HPP
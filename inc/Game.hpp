@@ -5,15 +5,34 @@
 #include "Bomb.hpp"
 #include "Boss.hpp"
 #include "BossAttack.hpp"
+#include "Difficulty.hpp"
+#include "Netplay.hpp"
 #include "Player.hpp"
+#include "Replay.hpp"
+#include "RunStore.hpp"
+#include "Script.hpp"
+#include "TimerWheel.hpp"
 #include "raylib.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <future>
 #include <memory>
+#include <span>
 #include <vector>
 #ifdef DISCORD_RPC_ENABLED
 #include "discordrpc.h"
 #endif
 
-enum class GameState { PLAYING, GAME_OVER, WIN, PAUSED, MAIN_MENU, GAME_ERROR_TEXTURE };
+enum class GameState {
+    PLAYING,
+    GAME_OVER,
+    WIN,
+    PAUSED,
+    MAIN_MENU,
+    GAME_ERROR_TEXTURE,
+    CONNECTING // waiting for the co-op session
+};
 
 struct TextSegment
 {
@@ -30,9 +49,11 @@ public:
     ~Game() = default;
 
     std::unique_ptr<Player> player;
+    std::unique_ptr<Player> partner; // the second player, only in co-op
     bool shouldClose;
     bool shouldRestart;
     static float gameTime;
+    static float deltaTime; // gameplay step of this frame, fixed while benchmarking
     std::vector<Music> bgMusics{};
 
     void init();
@@ -41,16 +62,25 @@ public:
     void draw() const;
     void handleInput();
     void updateTimers();
+    // one step of the simulation with deltaTime, the same for live play and replays.
+    // partnerInput moves the second player in co-op
+    void tick(const PlayerInput &input, const PlayerInput &partnerInput = {});
     void updateFrame();
     void cleanup();
     void setGameState(GameState newState);
     void shakeWindow(float duration, float intensity);
+    // the whole simulation state at a tick boundary, a replay keyframe
+    void saveState(std::vector<uint8_t> &bytes) const;
+    // replaces the running game with a saved state, false if the bytes were damaged
+    bool loadState(std::span<const uint8_t> bytes);
     static float drawTextCenter(const char *text, float x, float y, float fontSize, Color color);
     static float
     drawTextCombined(float x, float y, float fontSize, std::initializer_list<TextSegment> segments);
     static void marqueeText(const char *text, float y, float fontSize, Color color, float speed);
+    static const char *formatTime(float time); // mm:ss.cc
     void disconnectDiscord();
     void connectDiscord();
+    [[nodiscard]] GameState getGameState() const;
     Music *getBGMusic() const;
     void setBGMusic(Music *music);
 
@@ -62,29 +92,85 @@ private:
     DiscordRPC discord{};
     DiscordActivity discordActivity{};
 #endif
-    float bombTimer;
-    float attackTimer;
+    std::future<void> discordTask; // the connect of the first init, polled after each frame
     float timeEnd;
     std::unique_ptr<Boss> boss;
     std::vector<std::unique_ptr<BossAttack>> bossAttacks;
+    std::vector<std::unique_ptr<BossAttack>> freeAttacks; // finished attacks kept for reuse
     std::vector<std::unique_ptr<Bomb>> bombs;
+    std::vector<std::unique_ptr<Bomb>> freeBombs;
     Texture2D bossTexture{};
     Texture2D playerTexture{};
     Texture2D bombTexture{};
     Texture2D lareiTexture{};
     Music *bgMusic{};
     bool isShaking;
+    TimerId shakeTimer{};
     float shakeEndTime{};
     float shakeIntensity{};
     Vector2 windowPos{};
     int currentFPS = 0;
     float fpsTimer = 0.f;
     int framesThisSecond = 0;
+    std::chrono::steady_clock::time_point initStart{};
+    bool firstFrameShown = false;
+    size_t bulletCount = 0; // after the last tick
+    uint32_t tickSteps = 0; // REPLAY_STEP_SECONDS in deltaTime
+    ReplayStepClock stepClock;
+    float replayClock = 0.f; // game time the replay should be at
+    bool inputInterrupted = true; // a menu or pause was shown since the last tick
+    std::vector<uint8_t> keyframe{}; // reused for every keyframe of the recording
+    // the state before each of the last ticks of a co-op game, rollbacks start from them
+    std::array<std::vector<uint8_t>, Netplay::HISTORY> snapshots{};
+    uint32_t netTick = 0; // the next co-op tick to simulate
+    float netClock = 0.f; // real time not simulated yet
+    uint32_t nextCheck = 0; // the next tick whose state is compared with the peer
+    ScriptScheduler::Handle attackScriptHandle{};
+    ScriptScheduler::Handle bombScriptHandle{};
 
+    // solo runs are recorded, kept and raced, benchmarks, replays and co-op aren't
+    [[nodiscard]] bool isRecordedRun() const;
+    // the player an attack aims at, either one at random in co-op
+    [[nodiscard]] const Player &attackTarget() const;
     void createAttack();
+    // the tick without its end, PLAYING or the state the game ended in
+    [[nodiscard]] GameState step(const PlayerInput &input, const PlayerInput &partnerInput);
+    template <Difficulty D> void spawnAttackWave();
     void spawnBomb();
+    // gameplay scripts, restarted by reset(). a restored script first waits out the delay
+    // it was in when the state was saved
+    Script attackScript(TimerDue resume);
+    Script bombScript(TimerDue resume);
+    Script bossPhaseScript();
+    // after the timers of the state are on the wheel, the delays are scheduled right away
+    void spawnScripts(TimerDue attackDue, TimerDue bombDue);
+    // sets the game up from the header and keyframe 0 of ReplayPlayback
+    void startReplay();
+    // steps the recorded ticks of this frame, with fast forward and seeking
+    void playReplay();
+    void seekReplay(float target);
+    // ticks that are never shown, of a seek or a rollback, run without sounds, the info log
+    // of every hit or counting towards a hitch. ticks returns false if the state it loaded
+    // was damaged
+    template <typename Ticks> bool resimulate(Ticks ticks);
+    void saveReplay(RunResult result, RunMode mode);
+    // both players on the board of the host, once the session of --host or --join runs
+    void startNetGame();
+    // closes the session and goes back to the menu
+    void endNetGame();
+    // rolls back what was mispredicted and steps the fixed co-op ticks of this frame
+    void playNet();
+    // false when the tick ended the game on predicted input, it's undone and tried again
+    // until the peer's input confirms it. only a confirmed end changes the game state
+    bool simulateNetTick(uint32_t number);
     [[nodiscard]] const char *formatTime() const;
+    // the best run of the current board, or that this one is it
+    static void drawBestTime(RunMode mode, float y);
     void setDiscordActivity(const char *state, const char *details, float startTimestamp);
+    void openDiscord();
+    // sends the activity set in the meantime once the startup connect is done
+    void pollDiscord();
+    void joinDiscordTask();
 };
 
 #endif // GAME_HPP
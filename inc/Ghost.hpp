@@ -0,0 +1,40 @@
+#pragma once
+#ifndef GHOST_HPP
+#define GHOST_HPP
+
+#include "Player.hpp"
+#include "Replay.hpp"
+#include "raylib.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#define GHOST_ALPHA 0.35f
+
+// the record run of the current board drawn as a translucent player to race against. only its
+// player is simulated, from the recorded input alone, the movement doesn't depend on anything
+// else. a recorded tick costs a decoded token and a Player::update, and a frame decodes only
+// as far as the live game time within a small budget
+class Ghost
+{
+public:
+    // opens replays/best-<board>.bkr when there is one, from Game::reset()
+    static void start(size_t board, const Texture2D &texture);
+    static void stop();
+    // catches up with the live game time, what doesn't fit the budget follows next frame
+    static void update(float gameTime);
+    static void draw();
+
+private:
+    static constexpr int MAX_TICKS_PER_FRAME = 64;
+    static constexpr uint64_t FRAME_BUDGET_NS = 50'000; // checked every few ticks
+
+    static ReplayFile file;
+    static ReplayCursor cursor;
+    static std::unique_ptr<Player> player;
+    static float time; // game time the ghost is at
+    static bool finished; // the record run ended here
+};
+
+#endif // GHOST_HPP
@@ -0,0 +1,54 @@
+#pragma once
+#ifndef HITPREDICTOR_HPP
+#define HITPREDICTOR_HPP
+
+#include "Bullet.hpp"
+#include "Player.hpp"
+#include "StateBuffer.hpp"
+#include "raylib.h"
+
+#include <cstdint>
+
+// straight line the player is assumed to follow until its movement changes
+struct PlayerPath
+{
+    Vector2 origin;
+    Vector2 velocity; // pixels per second
+    float time;
+
+    [[nodiscard]] Vector2 at(float t) const
+    {
+        return {origin.x + velocity.x * (t - time), origin.y + velocity.y * (t - time)};
+    }
+};
+
+struct PredictedHit
+{
+    float time;
+    uint32_t bullet; // index into the attack's bullets
+
+    // std heap functions build a max heap, invert the order to get the earliest hit on top
+    bool operator<(const PredictedHit &other) const { return time > other.time; }
+};
+
+// bullets move on straight lines at constant velocity, so instead of stepping and
+// testing them every frame we solve for the earliest hit against the player path once
+// and only re-solve when the player leaves that path
+class HitPredictor
+{
+public:
+    static bool enabled;     // applied on Game::reset, bullets of a run never mix modes
+    static bool pathChanged; // true for the frame the path was re-planned on
+    static PlayerPath path;
+
+    static void reset();
+    static void save(StateWriter &writer);
+    static void load(StateReader &reader);
+    static void updatePath(const Player &player, float now, float deltaTime);
+    [[nodiscard]] static float solve(const Bullet &bullet, float from);
+
+private:
+    static bool hasPath;
+};
+
+#endif // HITPREDICTOR_HPP
@@ -0,0 +1,111 @@
+#pragma once
+#ifndef HITCHDETECTOR_HPP
+#define HITCHDETECTOR_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+
+#define HITCH_LOG_FILE_NAME "hitches.log"
+#define HITCH_DEFAULT_FACTOR 3.f
+
+// frame-time watchdog, a frame that takes more than factor times the median of the last
+// frames is a hitch. it snapshots the entity counts, the self time of every profile zone
+// against its usual cost, the TraceLog lines of the frame and how many entities were
+// recycled, and the snapshots are appended to hitches.log once gameplay stops
+class HitchDetector
+{
+public:
+    // installs the TraceLog counter, call on the main thread before anything logs
+    static void init(float factor);
+    // forgets the frame history, e.g. after loading when the next frame is slow anyway
+    static void reset();
+    static void endFrame();
+    // writes the pending snapshots to the hitch log, keep it out of gameplay frames
+    static void flush();
+
+    static void recordEntities(size_t bullets, size_t attacks, size_t bombs);
+    static void recordRecycled(size_t count)
+    {
+        if (!suspended)
+            recycled += count;
+    }
+    // ticks simulated again belong to the zone that runs them, their recycles, entity
+    // counts and log lines on this thread aren't recorded while suspended
+    static void setSuspended(bool suspend) { suspended = suspend; }
+
+    // profile zones only measure themselves on the main thread
+    [[nodiscard]] static bool isWatching() { return watching; }
+    static void enterZone();
+    // name must be a string literal, only the pointer is stored
+    static void exitZone(const char *name, uint64_t duration);
+
+private:
+    static constexpr size_t HISTORY = 120; // frames in the rolling median
+    static constexpr size_t MAX_ZONES = 32;
+    static constexpr size_t MAX_DEPTH = 16;
+    static constexpr size_t MAX_PENDING = 64; // snapshots waiting for flush()
+
+    struct Zone
+    {
+        const char *name;
+        uint64_t self; // ns this frame
+        float usual; // ms, moving average over frames that weren't hitches
+    };
+
+    struct ZoneSample
+    {
+        const char *name;
+        float ms;
+        float usualMs;
+    };
+
+    struct Snapshot
+    {
+        std::time_t wallTime;
+        float gameTime;
+        float frameMs;
+        float medianMs;
+        size_t bullets;
+        size_t attacks;
+        size_t bombs;
+        size_t recycled;
+        uint32_t logLines;
+        float logMs;
+        std::array<ZoneSample, MAX_ZONES + 1> zones; // the last one is time outside the zones
+        size_t zoneCount;
+    };
+
+    static float factor;
+    static thread_local bool watching;
+    static thread_local bool suspended;
+    static std::array<float, HISTORY> history; // seconds
+    static size_t historyCount;
+    static size_t historyNext;
+    static uint64_t lastFrameEnd; // 0 after reset()
+    static std::array<Zone, MAX_ZONES> zones;
+    static size_t zoneCount;
+    static std::array<uint64_t, MAX_DEPTH> childTime; // per open zone, ns spent in its children
+    static size_t depth;
+    static uint64_t zonedTime; // ns this frame inside top level zones
+    static float usualOutside;
+    static size_t bullets;
+    static size_t attacks;
+    static size_t bombs;
+    static size_t recycled;
+    // TraceLog is called from the loader threads too
+    static std::atomic<uint32_t> logLines;
+    static std::atomic<uint64_t> logTime;
+    static std::array<Snapshot, MAX_PENDING> pending;
+    static size_t pendingCount;
+    static uint32_t dropped;
+
+    static void countLog(int logLevel, const char *text, va_list args);
+    static float median();
+    static void snapshot(float frameTime, float medianTime);
+};
+
+#endif // HITCHDETECTOR_HPP
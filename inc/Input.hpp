@@ -18,6 +18,8 @@ public:
     static bool isEscapeKey();
     static bool isPauseKey();
     static bool isResetKey();
+    static bool isTraceKey();
+    static bool isCaptureKey();
     static bool isEnterOrSpace();
     static bool isKeyPressed(KeyboardKey key);
     static bool isArrowUp();
@@ -2,7 +2,7 @@
 #ifndef MAINMENU_HPP
 #define MAINMENU_HPP
 
-enum class MainMenuState { MAIN_MENU, SELECT_DIFFICULTY, CREDITS, SETTINGS };
+enum class MainMenuState { MAIN_MENU, SELECT_DIFFICULTY, CREDITS, SETTINGS, LEADERBOARD };
 
 class MainMenu
 {
@@ -15,13 +15,17 @@ public:
 private:
     static int selectedOption;
     static int selectedDifficulty;
-    static constexpr int mainMenuOptions = 4;
+    static int selectedBoard;
+    static constexpr int mainMenuOptions = 5;
+    static constexpr int leaderboardRows = 10;
 
     static void drawMainMenu();
     static void handleMainMenuInput();
     static void drawDifficultySelection();
     static void handleDifficultyInput();
     static void drawCredits();
+    static void drawLeaderboard();
+    static void handleLeaderboardInput();
 };
 
 #endif // MAINMENU_HPP
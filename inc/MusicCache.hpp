@@ -0,0 +1,49 @@
+#pragma once
+#ifndef MUSICCACHE_HPP
+#define MUSICCACHE_HPP
+
+#include "raylib.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define MUSIC_CACHE_DIR "music-cache"
+
+// decodes the compressed background music once into 16 bit PCM wav files in the config
+// directory and streams those from a memory mapping, playing them only copies samples
+// instead of decoding mp3 frames on the audio thread. a cache file is named after the
+// hash of its source, a changed track is decoded again and the stale file removed
+class MusicCache
+{
+public:
+    // --no-music-cache streams the source files directly
+    static void setEnabled(bool enabled) { MusicCache::enabled = enabled; }
+    // falls back to LoadMusicStream when the cache can't be used, thread safe
+    static Music load(const char *path);
+    // frees the cached pcm, every music stream from load() must be unloaded before
+    static void release();
+
+private:
+    struct Mapping
+    {
+        unsigned char *data;
+        size_t size;
+    };
+
+    static bool enabled;
+    static std::vector<Mapping> mappings; // guarded by mappingsMutex
+    static std::mutex mappingsMutex;
+
+    static uint64_t hashFile(const unsigned char *data, size_t size);
+    static bool decode(const char *fileType,
+                       const unsigned char *source,
+                       int sourceSize,
+                       const std::string &path);
+    static Mapping map(const std::string &path);
+    static void unmap(const Mapping &mapping);
+};
+
+#endif // MUSICCACHE_HPP
@@ -0,0 +1,127 @@
+#pragma once
+#ifndef NETPLAY_HPP
+#define NETPLAY_HPP
+
+#include "Difficulty.hpp"
+#include "Player.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define NET_DEFAULT_PORT 7777
+// the co-op simulation runs in fixed ticks of this many replay steps, about 1/60 s
+#define NET_TICK_STEPS 167
+// local input is used this many ticks after it was read, it usually arrives at the peer
+// before it's needed and nothing has to be predicted
+#define NET_INPUT_DELAY 2
+// ticks the simulation may run ahead of the peer's confirmed input, then it waits
+#define NET_MAX_PREDICTION 8
+#define NET_TIMEOUT_SECONDS 5.f
+// ticks between the state checksums both sides compare
+#define NET_CHECK_INTERVAL 60
+
+enum class NetState { OFF, CONNECTING, RUNNING, DISCONNECTED };
+
+// two player co-op over UDP with GGPO style rollback (--host / --join). only the input of
+// every tick is exchanged, each side runs the whole simulation. input of the peer that
+// hasn't arrived yet is predicted by repeating its last one, Game rolls back to the snapshot
+// of the first tick that was mispredicted and simulates it again. every packet carries all
+// input the peer hasn't acknowledged, so a lost packet is covered by the next one.
+// --net-delay and --net-loss put latency and loss on everything sent, for testing two
+// processes on localhost
+class Netplay
+{
+public:
+    static constexpr uint32_t HISTORY = 64; // ticks of input, more than can be predicted
+    static constexpr uint32_t NO_ROLLBACK = UINT32_MAX;
+
+    // the host picks the seed and the difficulty and waits for one peer
+    static bool host(uint16_t port);
+    // address is host:port, IPv4 or a name
+    static bool join(const char *address);
+    static void setShim(int delayMs, int lossPercent);
+    // sends a goodbye and closes the socket
+    static void close();
+    // sends and receives, once per frame while a session is open
+    static void poll();
+
+    [[nodiscard]] static NetState state() { return netState; }
+    [[nodiscard]] static bool isHost() { return hosting; }
+    [[nodiscard]] static uint16_t port() { return localPort; }
+    [[nodiscard]] static uint64_t seed() { return sessionSeed; }
+    [[nodiscard]] static Difficulty difficulty() { return sessionDifficulty; }
+
+    // in tick order, tick + NET_INPUT_DELAY of the tick being simulated
+    static void setLocalInput(uint32_t tick, const PlayerInput &input);
+    [[nodiscard]] static PlayerInput localInput(uint32_t tick);
+    // the confirmed input, or the prediction, which is remembered to be checked later
+    [[nodiscard]] static PlayerInput remoteInput(uint32_t tick);
+    // the peer's input is known for every tick below this
+    [[nodiscard]] static uint32_t confirmedTicks() { return remoteTicks; }
+    // the first tick that was simulated with a wrong prediction, NO_ROLLBACK when none
+    static uint32_t takeRollback();
+    // checksum of the state before a confirmed tick, compared with the peer's
+    static void addChecksum(uint32_t tick, const std::vector<uint8_t> &state);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    enum class PacketType : uint8_t { HELLO, START, INPUT, BYE };
+
+    struct DelayedPacket
+    {
+        Clock::time_point sendTime;
+        std::vector<uint8_t> bytes;
+    };
+
+    struct Checksum
+    {
+        uint32_t tick;
+        uint64_t hash;
+    };
+
+    static NetState netState;
+    static bool hosting;
+    static intptr_t socketHandle; // -1 when closed
+    static uint16_t localPort;
+    static uint32_t peerAddress; // network byte order, 0 until known
+    static uint16_t peerPort;
+    static Clock::time_point lastReceived;
+    static Clock::time_point lastHello;
+    static uint64_t sessionSeed;
+    static Difficulty sessionDifficulty;
+
+    static std::array<PlayerInput, HISTORY> localInputs;
+    static uint32_t localTicks; // local input is set for every tick below this
+    static uint32_t remoteAck; // the peer has our input for every tick below this
+    static std::array<PlayerInput, HISTORY> remoteInputs;
+    static uint32_t remoteTicks;
+    static std::array<PlayerInput, HISTORY> predictions;
+    static uint32_t predictedTicks; // ticks below this may have been predicted
+    static uint32_t rollbackTick;
+    static std::array<Checksum, 4> checksums; // the last ones of this side
+    static size_t checksumCount;
+    static Checksum peerChecksum; // the last one the peer sent
+    static uint32_t rollbacks;
+    static bool desynced;
+
+    static std::chrono::milliseconds shimDelay;
+    static int shimLoss; // percent
+    static std::vector<DelayedPacket> delayed;
+    static std::vector<uint8_t> packet; // reused for everything sent
+
+    static void startSession();
+    static void receive();
+    static void handlePacket(const uint8_t *data, size_t size, uint32_t address, uint16_t port);
+    static void sendInput();
+    // payload follows the packet header, sent through the shim
+    static void sendPacket(PacketType type, const void *payload, size_t size);
+    static void sendRaw(const std::vector<uint8_t> &bytes);
+    static void flushDelayed();
+    static void compareChecksum();
+};
+
+#endif // NETPLAY_HPP
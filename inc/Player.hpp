@@ -2,25 +2,56 @@
 #ifndef PLAYER_HPP
 #define PLAYER_HPP
 
+#include "StateBuffer.hpp"
 #include "raylib.h"
 
+#include <cstdint>
+
+// everything the player did in one tick, quantized so a replay stores exactly what the
+// live game simulated
+struct PlayerInput
+{
+    enum Button : uint8_t {
+        UP = 1 << 0,
+        DOWN = 1 << 1,
+        LEFT = 1 << 2,
+        RIGHT = 1 << 3,
+        MOUSE = 1 << 4, // walk to mouseX, mouseY
+        RESET_TARGET = 1 << 5, // first tick after a menu or pause
+    };
+
+    uint8_t buttons = 0;
+    int8_t stickX = 0; // gamepad left stick, 127 is fully pushed
+    int8_t stickY = 0;
+    int16_t mouseX = 0;
+    int16_t mouseY = 0;
+
+    bool operator==(const PlayerInput &) const = default;
+};
+
 class Player
 {
 public:
-    explicit Player(const Texture2D &texture);
+    // slot 1 is the second player of a co-op game
+    explicit Player(const Texture2D &texture, int slot = 0);
 
     float health{};
-    Texture2D texture;
+    const Texture2D &texture; // owned by Game, so reloads and restarts show up here
     Vector2 position{};
     Vector2 velocity{};
 
     void draw() const;
-    void update();
+    void update(const PlayerInput &input, float deltaTime);
     void init();
+    void save(StateWriter &writer) const;
+    void load(StateReader &reader);
+    [[nodiscard]] static PlayerInput readInput();
     void takeDamage(float damage);
     void resetMouseTarget();
+    void setMoveTarget(Vector2 target); // walks there like a mouse click
 
 private:
+    int slot;
     Vector2 previousPosition{};
     Vector2 mouseTarget{};
     bool isMouseTargetSet{};
@@ -0,0 +1,76 @@
+#pragma once
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include "HitchDetector.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#define TRACE_FILE_NAME "trace.json"
+#define TRACE_DEFAULT_SECONDS 10.f
+
+// records named zones into per-thread buffers while a capture is running and exports
+// them as a Chrome trace-event JSON file, which opens in Perfetto or chrome://tracing
+class Profiler
+{
+public:
+    // captures for the given number of seconds, 0 keeps capturing until stop()
+    static void start(const std::string &path, float seconds);
+    // ends the capture and writes the trace file
+    static void stop();
+    static void endFrame();
+    // names the calling thread in the trace, the first registered thread is "main"
+    static void setThreadName(const char *name);
+
+    [[nodiscard]] static bool isCapturing()
+    {
+        return capturing.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] static uint64_t now();
+    // name must be a string literal, only the pointer is stored
+    static void record(const char *name, uint64_t begin, uint64_t end);
+
+private:
+    static std::atomic<bool> capturing;
+    static std::string outputPath;
+    static uint64_t captureStart;
+    static uint64_t captureEnd; // 0 means no time limit
+};
+
+// zones on the main thread are also timed for the HitchDetector, outside of captures too
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const char *zoneName)
+        : name(zoneName), watched(HitchDetector::isWatching()),
+          begin(watched || Profiler::isCapturing() ? Profiler::now() : 0)
+    {
+        if (watched)
+            HitchDetector::enterZone();
+    }
+    ~ProfileZone()
+    {
+        if (begin == 0)
+            return;
+        const uint64_t end = Profiler::now();
+        // zones that began before the capture are dropped when it's written
+        if (Profiler::isCapturing())
+            Profiler::record(name, begin, end);
+        if (watched)
+            HitchDetector::exitZone(name, end - begin);
+    }
+
+    ProfileZone(const ProfileZone &) = delete;
+    ProfileZone &operator=(const ProfileZone &) = delete;
+
+private:
+    const char *name;
+    bool watched;
+    uint64_t begin; // 0 when nothing measures the zone
+};
+
+#define PROFILE_ZONE(name) const ProfileZone profileZone(name)
+
+#endif // PROFILER_HPP
@@ -0,0 +1,51 @@
+#pragma once
+#ifndef QUALITYGOVERNOR_HPP
+#define QUALITYGOVERNOR_HPP
+
+#include <cstdint>
+
+// each level also keeps everything dropped by the ones before it
+enum class QualityLevel : uint8_t {
+    FULL,
+    SIMPLE_BULLETS, // squares instead of DrawCircleV
+    NO_BOMB_PULSE,
+    LOW_RESOLUTION, // render target capped at QUALITY_REDUCED_SCALE
+    NO_SHAKE,
+};
+
+#define QUALITY_REDUCED_SCALE 0.75f
+
+// watches the frame time while playing and trades visual cost for frame rate when frames
+// go over budget, stepping back up once there is room again. only drawing reads the
+// level, the simulation is the same at every level
+class QualityGovernor
+{
+public:
+    // called once per gameplay frame with the measured frame time
+    static void update(float frameTime);
+
+    [[nodiscard]] static bool simpleBullets() { return level >= QualityLevel::SIMPLE_BULLETS; }
+    [[nodiscard]] static bool bombPulse() { return level < QualityLevel::NO_BOMB_PULSE; }
+    [[nodiscard]] static bool shake() { return level < QualityLevel::NO_SHAKE; }
+    // render scale to use for the configured one at the current level
+    [[nodiscard]] static float renderScale(float configured);
+
+private:
+    static constexpr int WINDOW_FRAMES = 30; // a decision every half second at 60 fps
+    static constexpr float DOWN_RATIO = 1.2f; // mean frame time over budget that steps down
+    static constexpr float UP_RATIO = 1.05f;  // and back under that steps up again
+    static constexpr float UP_HOLD = 3.f;     // seconds at a level before stepping up
+    static constexpr float UP_HOLD_MAX = 60.f;
+
+    static QualityLevel level;
+    static float windowSum;
+    static int windowFrames;
+    static double lastChange;
+    static double lastStepUp;
+    static float upHold; // doubles every time stepping up had to be undone right away
+
+    static float frameBudget();
+    static void setLevel(QualityLevel newLevel, float mean, float budget);
+};
+
+#endif // QUALITYGOVERNOR_HPP
@@ -0,0 +1,29 @@
+#pragma once
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <array>
+#include <cstdint>
+
+// random numbers of the simulation (attacks, patterns, bombs). unlike raylib's generator
+// the state can be saved and restored, so a replay keyframe continues with the same
+// numbers. cosmetic randomness like the screen shake keeps using GetRandomValue
+class Random
+{
+public:
+    using State = std::array<uint32_t, 4>;
+
+    static void seed(uint64_t seed);
+    // uniform in [min, max], same contract as GetRandomValue
+    static int value(int min, int max);
+
+    [[nodiscard]] static State getState() { return state; }
+    static void setState(const State &newState) { state = newState; }
+
+private:
+    static State state; // xoshiro128**
+
+    static uint32_t next();
+};
+
+#endif // RANDOM_HPP
@@ -0,0 +1,28 @@
+/* force-included into the raylib sources when ALLOC_TRACKING is on,
+   routes the RL_MALLOC family through the allocation tracker */
+#ifndef RAYLIBALLOCHOOKS_H
+#define RAYLIBALLOCHOOKS_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void *AllocTracker_malloc(size_t size);
+void *AllocTracker_calloc(size_t count, size_t size);
+void *AllocTracker_realloc(void *ptr, size_t size);
+void AllocTracker_free(void *ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifndef __cplusplus
+#define RL_MALLOC(sz) AllocTracker_malloc(sz)
+#define RL_CALLOC(n, sz) AllocTracker_calloc(n, sz)
+#define RL_REALLOC(ptr, sz) AllocTracker_realloc(ptr, sz)
+#define RL_FREE(ptr) AllocTracker_free(ptr)
+#endif
+
+#endif /* RAYLIBALLOCHOOKS_H */
@@ -0,0 +1,30 @@
+#pragma once
+#ifndef RENDERTARGET_HPP
+#define RENDERTARGET_HPP
+
+#include "raylib.h"
+
+#define RENDER_SCALE_MIN 0.5f
+#define RENDER_SCALE_MAX 2.f
+
+// the game always draws in SCREEN_WIDTH x SCREEN_HEIGHT coordinates into an offscreen
+// texture of that size times the render scale, which is blitted once to fit the window.
+// lower scales cut the fill cost on HiDPI panels and weak GPUs
+class RenderTarget
+{
+public:
+    static void init(float scale);
+    static void unload();
+    static void setScale(float scale);
+    [[nodiscard]] static float getScale() { return scale; }
+
+    static void begin();
+    // scales the frame into the window and presents it
+    static void present();
+
+private:
+    static RenderTexture2D target;
+    static float scale;
+};
+
+#endif // RENDERTARGET_HPP
@@ -0,0 +1,172 @@
+#pragma once
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+#include "Difficulty.hpp"
+#include "Player.hpp"
+#include "ReplayFormat.hpp"
+#include "TelemetryRecord.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// turns ticks into the token stream of ReplayFormat.hpp, one per block
+class ReplayInputEncoder
+{
+public:
+    void add(uint32_t steps, PlayerInput input);
+    // writes the pending run of unchanged ticks and starts the next block from scratch
+    void finish();
+
+    [[nodiscard]] std::vector<uint8_t> &bytes() { return output; }
+
+private:
+    std::vector<uint8_t> output;
+    PlayerInput previous{};
+    uint32_t previousSteps = 0;
+    uint32_t repeat = 0;
+};
+
+class ReplayInputDecoder
+{
+public:
+    ReplayInputDecoder() = default;
+    explicit ReplayInputDecoder(std::span<const uint8_t> bytes) : input(bytes) {}
+
+    // false at the end of the block, or where the bytes stop making sense
+    bool next(uint32_t &steps, PlayerInput &tick);
+
+private:
+    std::span<const uint8_t> input;
+    size_t offset = 0;
+    PlayerInput previous{};
+    uint32_t previousSteps = 0;
+    uint32_t repeat = 0;
+};
+
+// records the run being played, held in memory and written once it ends
+class ReplayRecorder
+{
+public:
+    // starts over, the first keyframe is the state after Game::reset()
+    static void begin(Difficulty difficulty, bool survival, bool hitPrediction);
+    [[nodiscard]] static bool isRecording() { return recording; }
+    // a keyframe is due once the last one is paid for by the byte budget, preferably while
+    // the screen is quiet since every bullet on it is part of the keyframe
+    [[nodiscard]] static bool wantsKeyframe(float gameTime, size_t bullets);
+    // closes the current block, state is what Game::saveState() wrote
+    static void addKeyframe(float gameTime, std::span<const uint8_t> state);
+    static void addTick(uint32_t steps, const PlayerInput &input, float gameTime);
+    // writes the replay next to the final name and renames it, false when that failed
+    static bool finish(const std::string &path, RunResult result);
+    static void discard();
+
+private:
+    static constexpr float KEYFRAME_INTERVAL = 10.f; // seconds, the shortest
+    static constexpr float KEYFRAME_MAX_INTERVAL = 40.f; // seconds, the most a seek simulates
+    // a keyframe holds the next one back until this budget paid for it
+    static constexpr float KEYFRAME_BYTES_PER_SECOND = 40.f;
+    static constexpr size_t QUIET_BULLETS = 64;
+
+    static bool recording;
+    static ReplayHeader header;
+    static std::vector<uint8_t> data; // blocks after the header
+    static std::vector<ReplayBlock> blocks;
+    static ReplayInputEncoder encoder;
+    static uint32_t tickCount;
+
+    static void closeBlock();
+};
+
+// a replay file opened for reading, mapped into memory on POSIX like the music cache
+class ReplayFile
+{
+public:
+    ReplayFile() = default;
+    ~ReplayFile() { close(); }
+    ReplayFile(const ReplayFile &) = delete;
+    ReplayFile &operator=(const ReplayFile &) = delete;
+
+    // checks the header and the index, false when the file is no usable replay
+    bool open(const std::string &path);
+    void close();
+    [[nodiscard]] bool isOpen() const { return data != nullptr; }
+
+    [[nodiscard]] const ReplayHeader &header() const { return info; }
+    [[nodiscard]] size_t blockCount() const { return blocks.size(); }
+    [[nodiscard]] const ReplayBlock &block(size_t index) const { return blocks[index]; }
+    [[nodiscard]] std::span<const uint8_t> keyframe(size_t index) const;
+    [[nodiscard]] std::span<const uint8_t> input(size_t index) const;
+    // the last block whose keyframe is at or before gameTime
+    [[nodiscard]] size_t blockAt(float gameTime) const;
+
+private:
+    unsigned char *data = nullptr;
+    size_t size = 0;
+    ReplayHeader info{};
+    std::vector<ReplayBlock> blocks; // copied out, the index needn't be aligned in the file
+};
+
+// walks the ticks of a ReplayFile, on into the next block when one ends. the keyframe there
+// is where the simulation already is
+class ReplayCursor
+{
+public:
+    void seek(const ReplayFile &replay, size_t index);
+    bool next(uint32_t &steps, PlayerInput &input);
+    [[nodiscard]] size_t block() const { return currentBlock; }
+
+private:
+    const ReplayFile *file = nullptr;
+    ReplayInputDecoder decoder;
+    size_t currentBlock = 0;
+};
+
+// game time of a tick with the given step count, the live game and every reader of a
+// replay have to compute it the same way
+[[nodiscard]] inline float replayStepSeconds(uint32_t steps)
+{
+    return static_cast<float>(steps) * REPLAY_STEP_SECONDS;
+}
+
+// turns frame times into step counts. the frame time jitters by a fraction of a millisecond
+// around the refresh rate, so the count is kept while the simulation stays close to real
+// time and a single tick catches up when it drifted too far. a steady frame rate records as
+// runs of repeated ticks instead of a new count every frame
+class ReplayStepClock
+{
+public:
+    uint32_t next(float frameTime);
+
+private:
+    static constexpr uint32_t RATE_TOLERANCE = 20; // steps, a frame further off is a new rate
+    static constexpr float MAX_DRIFT = 0.004f; // seconds, a quarter of a 60 fps frame
+
+    uint32_t rate = 0; // steps of the usual frame
+    float drift = 0.f; // real time not simulated yet
+};
+
+// feeds a replay from --replay to the game tick by tick
+class ReplayPlayback
+{
+public:
+    static bool open(const std::string &path);
+    static void close();
+    [[nodiscard]] static bool isActive() { return file.isOpen(); }
+    [[nodiscard]] static const ReplayHeader &header() { return file.header(); }
+
+    // the keyframe to load, the ticks continue from there
+    static std::span<const uint8_t> seek(size_t block);
+    [[nodiscard]] static size_t blockAt(float gameTime) { return file.blockAt(gameTime); }
+    [[nodiscard]] static size_t currentBlock() { return cursor.block(); }
+    static bool nextTick(uint32_t &steps, PlayerInput &input) { return cursor.next(steps, input); }
+
+private:
+    static ReplayFile file;
+    static ReplayCursor cursor;
+};
+
+#endif // REPLAY_HPP
@@ -0,0 +1,72 @@
+#pragma once
+#ifndef REPLAYFORMAT_HPP
+#define REPLAYFORMAT_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+// on-disk layout of a .bkr replay, raw bytes in native (little) endianness:
+//
+//   ReplayHeader
+//   block 0: keyframe bytes, input bytes
+//   block 1: ...
+//   ReplayBlock[blockCount] at indexOffset
+//
+// a keyframe is the full simulation state (Game::saveState), the input stream after it holds
+// every tick until the next keyframe. every block decodes on its own, seeking reads the
+// index, loads the keyframe at or before the target and only simulates the rest of that block
+#define REPLAY_MAGIC 0x50524B42u // "BKRP"
+#define REPLAY_VERSION 2
+#define REPLAY_DIR "replays"
+#define REPLAY_EXTENSION ".bkr"
+// live frame times are rounded to these steps, a tick stores how many of them it lasted
+#define REPLAY_STEP_SECONDS 0.0001f
+
+struct ReplayHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize; // sizeof(ReplayHeader) of the writer
+    int64_t timestamp; // unix time the run ended
+    uint64_t indexOffset;
+    uint32_t blockCount;
+    uint32_t tickCount;
+    float duration; // game time at the last tick
+    uint8_t difficulty; // Difficulty
+    uint8_t survival;
+    uint8_t hitPrediction; // changes the simulation, so the replay plays with the same setting
+    uint8_t result; // RunResult
+};
+
+struct ReplayBlock
+{
+    uint64_t offset; // of the keyframe, the input follows it
+    uint32_t keyframeSize;
+    uint32_t inputSize;
+    uint32_t firstTick;
+    uint32_t tickCount;
+    float gameTime; // of the keyframe
+    uint32_t reserved;
+};
+
+static_assert(std::is_trivially_copyable_v<ReplayHeader>);
+static_assert(sizeof(ReplayHeader) == 40, "changing the layout needs a version bump");
+static_assert(std::is_trivially_copyable_v<ReplayBlock>);
+static_assert(sizeof(ReplayBlock) == 32, "changing the layout needs a version bump");
+
+// the input stream is a sequence of varint tokens. the low bit tells them apart:
+//
+//   n << 1            n more ticks exactly like the previous one
+//   d << 4 | f << 1 | 1
+//                     one tick whose step count changed by zigzag(d) and whose fields in f
+//                     changed, their new values follow in this order:
+//                       REPLAY_FIELD_BUTTONS  1 byte
+//                       REPLAY_FIELD_STICK    2 bytes, x and y
+//                       REPLAY_FIELD_MOUSE    2 zigzag varints, x and y minus the previous
+//
+// the previous tick starts out as 0 steps and no input at the start of every block
+#define REPLAY_FIELD_BUTTONS 1u
+#define REPLAY_FIELD_STICK 2u
+#define REPLAY_FIELD_MOUSE 4u
+
+#endif // REPLAYFORMAT_HPP
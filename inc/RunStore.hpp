@@ -0,0 +1,99 @@
+#pragma once
+#ifndef RUNSTORE_HPP
+#define RUNSTORE_HPP
+
+#include "Difficulty.hpp"
+#include "TelemetryRecord.hpp"
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#define RUNS_FILE_NAME "runs.bin"
+#define RUNS_MAGIC 0x4E524B42u // "BKRN"
+#define RUNS_VERSION 1
+
+// one finished run in runs.bin, raw bytes in native (little) endianness. the checksum
+// covers everything before it, a torn or damaged record fails it and is dropped
+struct RunRecord
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size; // sizeof(RunRecord) of the writer
+    int64_t timestamp; // unix time the run ended
+    float gameTime; // seconds
+    uint32_t survivalLevel; // 0 outside survival
+    uint32_t peakEntities; // most entities at 60 fps, survival only
+    uint8_t difficulty; // Difficulty
+    uint8_t mode; // RunMode
+    uint8_t result; // RunResult
+    uint8_t reserved;
+    uint32_t reserved2;
+    uint32_t checksum;
+};
+
+static_assert(std::is_trivially_copyable_v<RunRecord>);
+static_assert(sizeof(RunRecord) == 40, "changing the layout needs a version bump");
+
+// history of every finished run and the leaderboards built from it. runs.bin in the config
+// directory is only ever appended to, records that fail their checksum are dropped by a
+// compaction that writes a new file and renames it over the old one. loading builds a ranked
+// index per difficulty and mode, so the best time and top lists are ready without touching
+// the file again. the file is written by a thread of its own
+class RunStore
+{
+public:
+    static constexpr size_t BOARD_COUNT = 4; // EASY, NORMAL, HARD, survival
+
+    // reads runs.bin and starts the writer, from a loader thread before anything else uses it
+    static void load();
+    // records a finished run, the ranking is updated at once and the file later
+    static void add(float gameTime,
+                    Difficulty difficulty,
+                    RunMode mode,
+                    RunResult result,
+                    uint32_t survivalLevel,
+                    uint32_t peakEntities);
+    // writes what is still queued and stops the writer
+    static void shutdown();
+
+    // normal mode boards rank the wins by the fastest time, the survival board every run by
+    // the longest one
+    [[nodiscard]] static size_t board(Difficulty difficulty, RunMode mode);
+    // indices into the run history, best first
+    [[nodiscard]] static std::span<const uint32_t> ranking(size_t board);
+    [[nodiscard]] static const RunRecord &get(uint32_t index) { return runs[index]; }
+    [[nodiscard]] static size_t runCount(size_t board) { return runCounts[board]; }
+    // the run add() recorded last
+    [[nodiscard]] static bool isLatest(uint32_t index) { return index + 1 == runs.size(); }
+
+private:
+    static std::vector<RunRecord> runs;
+    static std::array<std::vector<uint32_t>, BOARD_COUNT> rankings;
+    static std::array<size_t, BOARD_COUNT> runCounts;
+
+    // everything below is shared with the writer thread
+    static std::thread writer;
+    static std::mutex queueMutex;
+    static std::condition_variable queueChanged;
+    static std::vector<RunRecord> queue;
+    static std::vector<RunRecord> compaction; // replaces the file before the queue is appended
+    static bool compactPending;
+    static bool stopping;
+
+    static uint32_t checksum(const RunRecord &record);
+    static bool isValid(const RunRecord &record);
+    static bool isRanked(const RunRecord &record);
+    static bool isBetter(const RunRecord &a, const RunRecord &b);
+    static void writeLoop();
+    static void compact(const std::string &path);
+};
+
+#endif // RUNSTORE_HPP
@@ -0,0 +1,31 @@
+#pragma once
+#ifndef SAMPLINGPROFILER_HPP
+#define SAMPLINGPROFILER_HPP
+
+#ifdef SAMPLING_PROFILER
+
+#include <cstdint>
+#include <string>
+
+#define PROFILE_FILE_NAME "profile.folded"
+#define PROFILE_DEFAULT_HZ 997 // slightly off 1 kHz so samples don't lock step with timers
+
+// opt-in (SAMPLING_PROFILER build option, linux only) statistical CPU profiler, a SIGPROF
+// timer on the main thread's CPU clock walks the frame pointer chain and the stacks are
+// written as folded stacks for flamegraph tooling. frames inside the game are written as
+// offsets, tools/symbolize resolves them with the bombkurdistan.sym sidecar of the build
+class SamplingProfiler
+{
+public:
+    // must be called from the main thread, sampling stays paused until setActive(true)
+    static bool init(const std::string &path, int hz);
+    static void setActive(bool active);
+    // moves the samples out of the signal ring buffer, called once per frame
+    static void collect();
+    // stops sampling and writes the folded stacks
+    static void shutdown();
+};
+
+#endif // SAMPLING_PROFILER
+
+#endif // SAMPLINGPROFILER_HPP
@@ -0,0 +1,168 @@
+#pragma once
+#ifndef SCRIPT_HPP
+#define SCRIPT_HPP
+
+#include "TimerWheel.hpp"
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <utility>
+#include <vector>
+
+// gameplay scripts written as C++20 coroutines, e.g. a boss phase is a plain loop that
+// co_awaits ScriptScheduler::delay(), nextTick() or until(condition). the frames come from a
+// fixed pool and resuming never allocates, a frame only costs anything when it is due.
+// delays are timers on the TimerWheel
+class Script
+{
+public:
+    struct promise_type
+    {
+        Script get_return_object()
+        {
+            return Script(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        // started by the scheduler on its next update
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        // the scheduler destroys finished scripts
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+
+        static void *operator new(size_t size);
+        static void operator delete(void *ptr, size_t size);
+
+        TimerId delay{}; // timer of the last delay the script waited on
+    };
+
+    explicit Script(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+    Script(Script &&other) noexcept : handle(std::exchange(other.handle, {})) {}
+    Script &operator=(Script &&other) noexcept
+    {
+        if (this != &other) {
+            if (handle)
+                handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+    Script(const Script &) = delete;
+    Script &operator=(const Script &) = delete;
+    ~Script()
+    {
+        if (handle)
+            handle.destroy();
+    }
+
+private:
+    friend class ScriptScheduler;
+    std::coroutine_handle<promise_type> handle;
+};
+
+class ScriptScheduler
+{
+public:
+    using Handle = std::coroutine_handle<Script::promise_type>;
+
+    struct TickAwaiter
+    {
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { ticking.push_back(handle); }
+        void await_resume() const noexcept {}
+    };
+
+    struct DelayAwaiter
+    {
+        float seconds;
+
+        bool await_ready() const noexcept { return seconds <= 0.f; }
+        void await_suspend(Handle handle)
+        {
+            handle.promise().delay = TimerWheel::schedule(seconds, wake, handle.address());
+        }
+        void await_resume() const noexcept {}
+    };
+
+    struct ResumeAwaiter
+    {
+        TimerDue due;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(Handle handle)
+        {
+            handle.promise().delay = TimerWheel::scheduleAt(due, wake, handle.address());
+        }
+        void await_resume() const noexcept {}
+    };
+
+    // the condition lives in the suspended frame, the scheduler only keeps a pointer to it
+    template <typename Condition> struct UntilAwaiter
+    {
+        Condition condition;
+
+        bool await_ready() { return condition(); }
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            waiting.push_back({handle, this, [](void *self) {
+                                   return static_cast<UntilAwaiter *>(self)->condition();
+                               }});
+        }
+        void await_resume() const noexcept {}
+    };
+
+    // resumes on the next update
+    static TickAwaiter nextTick() { return {}; }
+    // resumes on the first update after the timer wheel reached seconds of game time later
+    static DelayAwaiter delay(float seconds) { return {seconds}; }
+    // waits for a delay saved with pendingDelay(), so a restored script fires on the same tick
+    static ResumeAwaiter resumeAt(TimerDue due) { return {due}; }
+    // checked on every update until it holds, keep conditions cheap
+    template <typename Condition> static UntilAwaiter<Condition> until(Condition condition)
+    {
+        return {std::move(condition)};
+    }
+
+    // the script starts on the next update, the handle stays valid until it finishes
+    static Handle spawn(Script script);
+    // {} unless the script is waiting on a delay
+    [[nodiscard]] static TimerDue pendingDelay(Handle handle)
+    {
+        return handle ? TimerWheel::due(handle.promise().delay) : TimerDue{};
+    }
+    // resumes every script that is due, after TimerWheel::advance() of the same frame
+    static void update();
+    // destroys every script, their frames go back to the pool. pending delays are timers on
+    // the wheel, clear it first
+    static void clear();
+
+    static void *allocateFrame(size_t size);
+    static void freeFrame(void *ptr, size_t size);
+
+private:
+    static constexpr size_t FRAME_SIZE = 512;
+    static constexpr size_t FRAME_COUNT = 16;
+
+    struct Waiter
+    {
+        std::coroutine_handle<> handle;
+        void *awaiter;
+        bool (*check)(void *awaiter);
+    };
+
+    alignas(std::max_align_t) static unsigned char frames[FRAME_COUNT][FRAME_SIZE];
+    static std::vector<uint8_t> freeFrames;
+    static std::vector<Script> scripts;
+    static std::vector<std::coroutine_handle<>> ticking;
+    static std::vector<std::coroutine_handle<>> resuming; // swapped with ticking
+    static std::vector<Waiter> waiting;
+
+    static void wake(void *address)
+    {
+        ticking.push_back(std::coroutine_handle<>::from_address(address));
+    }
+    static void resume(std::coroutine_handle<> handle);
+};
+
+#endif // SCRIPT_HPP
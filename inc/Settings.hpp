@@ -4,10 +4,13 @@
 
 #include "Constants.hpp"
 #include "Game.hpp"
+#include "RenderTarget.hpp"
 #include "raylib.h"
 
+#include <charconv>
 #include <fstream>
 #include <string>
+#include <string_view>
 
 enum class SettingsState { MAIN_MENU, VIDEO_SETTINGS, AUDIO_SETTINGS, OTHER_SETTINGS };
 
@@ -16,42 +19,60 @@ struct Config
     bool vsync;
     int targetFPS;
     bool fullscreen;
+    float renderScale; // internal resolution relative to SCREEN_WIDTH x SCREEN_HEIGHT
 
     float musicVolume;
+    float sfxVolume = 1.0f; // settings files from older versions have no sfxVolume
     int bgMusicIndex; // index of the selected background music track
 
     bool discordRPC;
     bool shakeScreen;
+    bool hitPrediction; // solve bullet hits analytically instead of testing every frame
 
     void writeFile(std::ofstream &file) const
     {
         file << "vsync=" << (vsync ? "1" : "0") << "\n";
         file << "targetFPS=" << targetFPS << "\n";
         file << "fullscreen=" << (fullscreen ? "1" : "0") << "\n";
+        file << "renderScale=" << renderScale << "\n";
         file << "musicVolume=" << musicVolume << "\n";
+        file << "sfxVolume=" << sfxVolume << "\n";
         file << "bgMusicIndex=" << bgMusicIndex << "\n";
         file << "discordRPC=" << (discordRPC ? "1" : "0") << "\n";
         file << "shakeScreen=" << (shakeScreen ? "1" : "0") << "\n";
+        file << "hitPrediction=" << (hitPrediction ? "1" : "0") << "\n";
     }
 
-    void fromKey(const std::string &key, const std::string &value)
+    void fromKey(std::string_view key, std::string_view value)
     {
+        // parse numbers in place, invalid values keep the current setting
+        const auto toNumber = [value](auto &out) {
+            std::from_chars(value.data(), value.data() + value.size(), out);
+        };
+
         if (key == "vsync")
             vsync = (value == "1");
         else if (key == "targetFPS")
-            targetFPS = std::stoi(value);
+            toNumber(targetFPS);
         else if (key == "fullscreen")
             fullscreen = (value == "1");
+        else if (key == "renderScale")
+            toNumber(renderScale);
         else if (key == "musicVolume")
-            musicVolume = std::stof(value);
+            toNumber(musicVolume);
+        else if (key == "sfxVolume")
+            toNumber(sfxVolume);
         else if (key == "bgMusicIndex")
-            bgMusicIndex = std::stoi(value);
+            toNumber(bgMusicIndex);
         else if (key == "discordRPC")
             discordRPC = (value == "1");
         else if (key == "shakeScreen")
             shakeScreen = (value == "1");
+        else if (key == "hitPrediction")
+            hitPrediction = (value == "1");
         else
-            TraceLog(LOG_WARNING, "Unknown setting: %s", key.c_str());
+            TraceLog(LOG_WARNING, "Unknown setting: %.*s", static_cast<int>(key.size()),
+                     key.data());
     }
 
     void healthCheck()
@@ -60,10 +81,18 @@ struct Config
             TraceLog(LOG_WARNING, "Invalid target FPS setting, resetting to default.");
             targetFPS = DEFAULT_GAME_FPS;
         }
+        if (!(renderScale >= RENDER_SCALE_MIN && renderScale <= RENDER_SCALE_MAX)) {
+            TraceLog(LOG_WARNING, "Invalid render scale setting, resetting to default.");
+            renderScale = 1.0f;
+        }
         if (musicVolume < 0.0f || musicVolume > 1.0f) {
             TraceLog(LOG_WARNING, "Invalid music volume setting, resetting to default.");
             musicVolume = 1.0f;
         }
+        if (!(sfxVolume >= 0.0f && sfxVolume <= 1.0f)) {
+            TraceLog(LOG_WARNING, "Invalid sound effect volume setting, resetting to default.");
+            sfxVolume = 1.0f;
+        }
         if (bgMusicIndex != 0 && bgMusicIndex != 1) { // currently we have only 2 tracks
             TraceLog(LOG_WARNING, "Invalid background music index, resetting to default.");
             bgMusicIndex = 0;
@@ -90,6 +119,8 @@ public:
     static void draw();
     static void save();
     static void load();
+    // path of a file in the config directory, next to settings.cfg
+    static std::string getConfigPath(const char *fileName);
 
 private:
     static SettingsState state;
@@ -0,0 +1,64 @@
+#pragma once
+#ifndef SFX_HPP
+#define SFX_HPP
+
+#include "raylib.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class SfxId : uint8_t { PLAYER_HIT, BOMB_PICKUP, BOSS_HIT, COUNT };
+
+// sound effects, the samples are synthesised once at startup and shared by a fixed pool of
+// voices. play() only counts the request, flush() starts at most one voice per effect each
+// frame, so a burst of hits costs the same mixing work as a single one. when every voice
+// is busy the lowest priority, oldest one is stolen
+class Sfx
+{
+public:
+    // needs the audio device
+    static void init();
+    static void unload();
+    static void setVolume(float volume);
+
+    static void play(SfxId id)
+    {
+        if (!muted)
+            ++requests[static_cast<size_t>(id)];
+    }
+    // ticks simulated again after a rollback were already heard the first time
+    static void setMuted(bool mute) { muted = mute; }
+    // starts the voices requested this frame, called once at the end of the frame
+    static void flush();
+
+private:
+    static constexpr size_t SFX_COUNT = static_cast<size_t>(SfxId::COUNT);
+    static constexpr size_t VOICE_COUNT = 8;
+
+    struct Voice
+    {
+        // an alias of every sample, a voice switches samples without loading anything
+        std::array<Sound, SFX_COUNT> aliases;
+        SfxId playing;
+        uint64_t startedFrame;
+    };
+
+    static std::array<Sound, SFX_COUNT> samples;
+    static std::array<Voice, VOICE_COUNT> voices;
+    static std::array<uint16_t, SFX_COUNT> requests;
+    static std::array<double, SFX_COUNT> lastStart;
+    static uint64_t frame;
+    static uint32_t noiseState;
+    static float volume;
+    static bool loaded;
+    static bool muted;
+
+    static void synthesise(SfxId id, std::vector<int16_t> &pcm);
+    static float noise();
+    static Voice *pickVoice(SfxId id);
+    [[nodiscard]] static bool isPlaying(const Voice &voice);
+};
+
+#endif // SFX_HPP
@@ -0,0 +1,69 @@
+#pragma once
+#ifndef STATEBUFFER_HPP
+#define STATEBUFFER_HPP
+
+#include "raylib.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// co-op peers hash these bytes, so a field can't have padding whose bytes are whatever the
+// memory held. floats have no unique representation (+0 and -0), Vector2 is two of them.
+// structs with padding are written field by field
+template <typename T>
+inline constexpr bool isStateField =
+    std::has_unique_object_representations_v<T> || std::is_floating_point_v<T>;
+template <> inline constexpr bool isStateField<Vector2> = sizeof(Vector2) == 2 * sizeof(float);
+
+// flat byte form of the simulation state (replay keyframes, co-op snapshots), fields are
+// copied as raw bytes in native endianness and read back in the same order they were written
+class StateWriter
+{
+public:
+    explicit StateWriter(std::vector<uint8_t> &bytes) : bytes(bytes) {}
+
+    template <typename T> void write(const T &value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        static_assert(isStateField<T>, "padding would be hashed, write the fields one by one");
+        const auto *data = reinterpret_cast<const uint8_t *>(&value);
+        bytes.insert(bytes.end(), data, data + sizeof(T));
+    }
+
+private:
+    std::vector<uint8_t> &bytes;
+};
+
+// reading past the end yields zeroed values and marks the reader as failed
+class StateReader
+{
+public:
+    explicit StateReader(std::span<const uint8_t> bytes) : bytes(bytes) {}
+
+    template <typename T> T read()
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        static_assert(isStateField<T>);
+        T value{};
+        if (sizeof(T) > bytes.size() - offset) {
+            failed = true;
+            return value;
+        }
+        std::memcpy(&value, bytes.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+
+    [[nodiscard]] bool hasFailed() const { return failed; }
+
+private:
+    std::span<const uint8_t> bytes;
+    size_t offset = 0;
+    bool failed = false;
+};
+
+#endif // STATEBUFFER_HPP
@@ -0,0 +1,36 @@
+#pragma once
+#ifndef SURVIVAL_HPP
+#define SURVIVAL_HPP
+
+#include <cstddef>
+
+// endless mode on top of HARD: the boss can't be beaten and every SURVIVAL_LEVEL_SECONDS
+// waves come faster, with more attacks and denser bullet rings, until the game falls over.
+// doubles as a stress test, the HUD shows the most entities that were alive in a frame
+// that still made 60 fps
+#define SURVIVAL_LEVEL_SECONDS 15.f
+
+class Survival
+{
+public:
+    static bool enabled;
+
+    static void reset();
+    // called once per gameplay frame
+    static void recordFrame(float frameTime, size_t entities);
+
+    [[nodiscard]] static int level();
+    [[nodiscard]] static float attackInterval();
+    [[nodiscard]] static int attacksPerWave();
+    // how many rotated copies of every pattern wave an attack emits
+    [[nodiscard]] static int bulletRepeat();
+
+    [[nodiscard]] static size_t liveEntities() { return live; }
+    [[nodiscard]] static size_t peakEntities() { return peak; }
+
+private:
+    static size_t live;
+    static size_t peak; // only frames at 60 fps or better count
+};
+
+#endif // SURVIVAL_HPP
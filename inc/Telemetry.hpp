@@ -0,0 +1,46 @@
+#pragma once
+#ifndef TELEMETRY_HPP
+#define TELEMETRY_HPP
+
+#include "TelemetryRecord.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// collects frame times and entity peaks of the current run without allocating and
+// appends a TelemetryRecord to telemetry.bin in the config directory when it ends
+class Telemetry
+{
+public:
+    static void reset();
+    static void recordFrame(float frameTime,
+                            float gameTime,
+                            size_t bullets,
+                            size_t attacks,
+                            size_t bombs);
+    static void endRun(RunResult result, RunMode mode, float gameTime);
+
+private:
+    // 0.1 ms buckets up to 100 ms, slower frames land in the last bucket
+    static constexpr size_t HISTOGRAM_BUCKETS = 1000;
+    static constexpr float BUCKET_MS = 0.1f;
+
+    struct Hitch
+    {
+        float frameTime;
+        float gameTime;
+    };
+
+    static std::array<uint32_t, HISTOGRAM_BUCKETS> histogram;
+    static std::array<Hitch, TELEMETRY_HITCH_COUNT> hitches; // slowest first
+    static uint32_t frameCount;
+    static float maxFrameTime;
+    static size_t peakBullets;
+    static size_t peakAttacks;
+    static size_t peakBombs;
+
+    static float percentile(float fraction);
+};
+
+#endif // TELEMETRY_HPP
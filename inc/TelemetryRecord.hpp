@@ -0,0 +1,51 @@
+#pragma once
+#ifndef TELEMETRYRECORD_HPP
+#define TELEMETRYRECORD_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+// on-disk layout of one run in telemetry.bin, shared with tools/telemetry_csv so it must
+// not depend on raylib. records are appended as raw bytes in native (little) endianness,
+// new fields go to the end with a version bump, readers skip records by their size
+#define TELEMETRY_FILE_NAME "telemetry.bin"
+#define TELEMETRY_MAGIC 0x4C544B42u // "BKTL"
+#define TELEMETRY_VERSION 2
+#define TELEMETRY_HITCH_COUNT 5
+
+enum class RunResult : uint8_t { GAME_OVER, WIN };
+// survival plays with the HARD rules, the mode keeps its runs apart
+enum class RunMode : uint8_t { NORMAL, SURVIVAL };
+
+struct TelemetryRecord
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size; // sizeof(TelemetryRecord) of the writer
+    int64_t timestamp; // unix time the run ended
+
+    float gameTime; // seconds
+    uint32_t frameCount;
+    // frame times in milliseconds
+    float frameTimeP50;
+    float frameTimeP90;
+    float frameTimeP99;
+    float frameTimeMax;
+    // worst frames of the run, slowest first, unused slots are 0
+    float hitchFrameTime[TELEMETRY_HITCH_COUNT]; // milliseconds
+    float hitchGameTime[TELEMETRY_HITCH_COUNT];  // seconds into the run
+
+    uint32_t peakBullets;
+    uint16_t peakAttacks;
+    uint16_t peakBombs;
+    int32_t targetFPS;
+    uint8_t difficulty; // Difficulty
+    uint8_t result;     // RunResult
+    uint8_t vsync;
+    uint8_t mode; // RunMode, since version 2, reserved and 0 before
+};
+
+static_assert(std::is_trivially_copyable_v<TelemetryRecord>);
+static_assert(sizeof(TelemetryRecord) == 96, "changing the layout needs a version bump");
+
+#endif // TELEMETRYRECORD_HPP
@@ -0,0 +1,82 @@
+#pragma once
+#ifndef TIMERWHEEL_HPP
+#define TIMERWHEEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define TIMER_TICKS_PER_SECOND 1000 // game time is bucketed into milliseconds
+
+struct TimerId
+{
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+};
+
+// when a timer fires, timers due on the same tick fire in the order they were scheduled.
+// saved with the replay keyframes, a restored timer keeps its place in that order
+struct TimerDue
+{
+    uint32_t tick = 0; // 0 for no timer
+    uint32_t sequence = 0;
+};
+
+// hierarchical timer wheel for timed gameplay events (explosions, bomb expiry, shake end,
+// script delays), keyed by integer ticks of game time. scheduling and cancelling are O(1),
+// advance() only touches the slots of the ticks that passed and runs everything that
+// expired as one batch, so an entity that is only waiting costs nothing per frame. the
+// batch runs in TimerDue order, which doesn't depend on how the timers sit in the slots
+class TimerWheel
+{
+public:
+    using Callback = void (*)(void *context);
+
+    // fires on the first advance() at least delay seconds of game time from now
+    static TimerId schedule(float delay, Callback callback, void *context);
+    // puts a saved timer back, due.tick must be after the current tick
+    static TimerId scheduleAt(TimerDue due, Callback callback, void *context);
+    // {} when the timer already fired or was cancelled
+    [[nodiscard]] static TimerDue due(TimerId id);
+    // a timer that already fired or was cancelled is ignored
+    static void cancel(TimerId id);
+    // moves the wheel to gameTime and runs the expired callbacks in due order
+    static void advance(float gameTime);
+    // forgets every timer and starts over at tick 0, for a new run, never from a callback
+    static void clear();
+    // clear(), then continues from a saved tick and sequence
+    static void restore(uint32_t tick, uint32_t sequence);
+
+    [[nodiscard]] static uint32_t tick() { return currentTick; }
+    [[nodiscard]] static uint32_t sequence() { return nextSequence; }
+
+private:
+    static constexpr uint32_t SLOT_BITS = 6;
+    static constexpr uint32_t SLOTS = 1u << SLOT_BITS;
+    static constexpr uint32_t LEVELS = 4; // 2^24 ms, about 4.6 hours, later timers wait at the top
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Timer
+    {
+        uint32_t due; // tick
+        uint32_t sequence;
+        uint32_t next; // next timer in the same slot
+        uint32_t generation;
+        bool cancelled;
+        Callback callback;
+        void *context;
+    };
+
+    static std::vector<Timer> timers; // pool, slots link into it by index
+    static std::vector<uint32_t> freeTimers;
+    static std::vector<uint32_t> expired; // batch of one advance()
+    static uint32_t slots[LEVELS][SLOTS];
+    static uint32_t currentTick;
+    static uint32_t nextSequence;
+
+    static void insert(uint32_t index);
+    static void cascade(uint32_t level);
+    static void release(uint32_t index);
+};
+
+#endif // TIMERWHEEL_HPP
@@ -0,0 +1,205 @@
+#include "AllocTracker.hpp"
+
+#ifdef ALLOC_TRACKING
+
+#include "Constants.hpp"
+#include "RaylibAllocHooks.h"
+#include "raylib.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+constexpr size_t TAG_COUNT = static_cast<size_t>(AllocTag::COUNT);
+constexpr const char *TAG_NAMES[TAG_COUNT] = {"other", "attacks", "bombs", "text", "audio"};
+constexpr uint32_t MAX_BUDGET_REPORTS = 10; // don't flood the log on a bad run
+
+// constant initialized, so allocations made before main are counted safely
+std::atomic<uint32_t> frameAllocations[TAG_COUNT]{};
+std::atomic<uint64_t> frameBytes[TAG_COUNT]{};
+std::atomic<uint32_t> frameRaylib{0};
+std::atomic<uint32_t> frameFrees{0};
+
+thread_local AllocTag currentTag = AllocTag::OTHER;
+} // namespace
+
+AllocTracker::Stats AllocTracker::lastFrame[TAG_COUNT]{};
+AllocTracker::Stats AllocTracker::peakFrame{};
+uint32_t AllocTracker::lastFrameRaylib = 0;
+uint32_t AllocTracker::lastFrameFrees = 0;
+uint32_t AllocTracker::budget = 0;
+uint32_t AllocTracker::exceededFrames = 0;
+uint64_t AllocTracker::frameIndex = 0;
+
+void AllocTracker::setBudget(uint32_t allocationsPerFrame)
+{
+    budget = allocationsPerFrame;
+    TraceLog(LOG_INFO, "Allocation budget set to %u allocations per frame", budget);
+}
+
+void AllocTracker::record(size_t size, bool fromRaylib)
+{
+    const auto tag = static_cast<size_t>(currentTag);
+    frameAllocations[tag].fetch_add(1, std::memory_order_relaxed);
+    frameBytes[tag].fetch_add(size, std::memory_order_relaxed);
+    if (fromRaylib)
+        frameRaylib.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AllocTracker::recordFree()
+{
+    frameFrees.fetch_add(1, std::memory_order_relaxed);
+}
+
+AllocTag AllocTracker::swapTag(AllocTag tag)
+{
+    const AllocTag previous = currentTag;
+    currentTag = tag;
+    return previous;
+}
+
+void AllocTracker::endFrame(bool checkBudget)
+{
+    Stats total{};
+    for (size_t t = 0; t < TAG_COUNT; ++t) {
+        lastFrame[t] = {frameAllocations[t].exchange(0, std::memory_order_relaxed),
+                        frameBytes[t].exchange(0, std::memory_order_relaxed)};
+        total.allocations += lastFrame[t].allocations;
+        total.bytes += lastFrame[t].bytes;
+    }
+    lastFrameRaylib = frameRaylib.exchange(0, std::memory_order_relaxed);
+    lastFrameFrees = frameFrees.exchange(0, std::memory_order_relaxed);
+
+    if (total.allocations > peakFrame.allocations)
+        peakFrame = total;
+
+    if (checkBudget && budget > 0 && total.allocations > budget) {
+        if (exceededFrames++ < MAX_BUDGET_REPORTS) {
+            TraceLog(LOG_ERROR,
+                     "Frame %llu exceeded the allocation budget: %u > %u (%llu bytes, %u raylib)",
+                     static_cast<unsigned long long>(frameIndex), total.allocations, budget,
+                     static_cast<unsigned long long>(total.bytes), lastFrameRaylib);
+            for (size_t t = 0; t < TAG_COUNT; ++t) {
+                if (lastFrame[t].allocations > 0)
+                    TraceLog(LOG_ERROR, "    %s: %u allocations, %llu bytes", TAG_NAMES[t],
+                             lastFrame[t].allocations,
+                             static_cast<unsigned long long>(lastFrame[t].bytes));
+            }
+        }
+    }
+
+    ++frameIndex;
+}
+
+void AllocTracker::drawOverlay()
+{
+    constexpr int fontSize = 10;
+    constexpr int lineHeight = 12;
+    int y = BOSS_HEIGHT + 10; // below the boss health bar
+
+    uint32_t allocations = 0;
+    uint64_t bytes = 0;
+    for (const Stats &stats : lastFrame) {
+        allocations += stats.allocations;
+        bytes += stats.bytes;
+    }
+
+    const Color color = (budget > 0 && allocations > budget) ? RED : LIGHTGRAY;
+    DrawText(TextFormat("alloc: %u (%llu B) free: %u raylib: %u peak: %u", allocations,
+                        static_cast<unsigned long long>(bytes), lastFrameFrees, lastFrameRaylib,
+                        peakFrame.allocations),
+             10, y, fontSize, color);
+
+    for (size_t t = 0; t < TAG_COUNT; ++t) {
+        y += lineHeight;
+        DrawText(TextFormat("  %s: %u (%llu B)", TAG_NAMES[t], lastFrame[t].allocations,
+                            static_cast<unsigned long long>(lastFrame[t].bytes)),
+                 10, y, fontSize, LIGHTGRAY);
+    }
+}
+
+// global new/delete replacements, everything the game and the standard library allocate
+void *operator new(size_t size)
+{
+    AllocTracker::record(size, false);
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    AllocTracker::record(size, false);
+    return std::malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    if (ptr)
+        AllocTracker::recordFree();
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept
+{
+    operator delete(ptr);
+}
+
+// raylib hooks, see RaylibAllocHooks.h
+void *AllocTracker_malloc(size_t size)
+{
+    AllocTracker::record(size, true);
+    return std::malloc(size);
+}
+
+void *AllocTracker_calloc(size_t count, size_t size)
+{
+    AllocTracker::record(count * size, true);
+    return std::calloc(count, size);
+}
+
+void *AllocTracker_realloc(void *ptr, size_t size)
+{
+    AllocTracker::record(size, true);
+    return std::realloc(ptr, size);
+}
+
+void AllocTracker_free(void *ptr)
+{
+    if (ptr)
+        AllocTracker::recordFree();
+    std::free(ptr);
+}
+
+#endif // ALLOC_TRACKING
@@ -0,0 +1,196 @@
+#include "AssetReloader.hpp"
+
+#ifdef HOT_RELOAD
+
+#include "Settings.hpp"
+
+#include <cmath>
+#include <string_view>
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+std::vector<AssetReloader::Watched> AssetReloader::watched{};
+std::vector<AssetReloader::Reload> AssetReloader::pending{};
+std::mutex AssetReloader::pendingMutex{};
+std::thread AssetReloader::worker{};
+std::atomic<bool> AssetReloader::running{false};
+std::string AssetReloader::directory{};
+
+namespace {
+std::string fileNameOf(const char *path)
+{
+    const std::string_view view(path);
+    const size_t slash = view.rfind('/');
+    return std::string(slash == std::string_view::npos ? view : view.substr(slash + 1));
+}
+} // namespace
+
+void AssetReloader::watchTexture(const char *path, Texture2D *texture)
+{
+    watched.push_back({fileNameOf(path), texture, nullptr, nullptr});
+}
+
+void AssetReloader::watchMusic(const char *path, Music *music)
+{
+    watched.push_back({fileNameOf(path), nullptr, music, nullptr});
+}
+
+void AssetReloader::start(const char *newDirectory)
+{
+    if (running.exchange(true))
+        return;
+    directory = newDirectory;
+    worker = std::thread(watch, directory);
+    TraceLog(LOG_INFO, "Hot reload: watching %zu assets in %s", watched.size(), newDirectory);
+}
+
+void AssetReloader::stop()
+{
+    if (running.exchange(false) && worker.joinable())
+        worker.join();
+
+    for (Reload &reload : pending)
+        freeReload(reload);
+    pending.clear();
+
+    // the music streams reading from this memory are unloaded before
+    for (Watched &entry : watched) {
+        if (entry.musicData)
+            UnloadFileData(entry.musicData);
+    }
+    watched.clear();
+}
+
+void AssetReloader::watch(const std::string &path)
+{
+    const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0 || inotify_add_watch(fd, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        TraceLog(LOG_WARNING, "Hot reload: could not watch %s", path.c_str());
+        if (fd >= 0)
+            close(fd);
+        return;
+    }
+
+    alignas(inotify_event) char buffer[4096];
+    while (running.load(std::memory_order_acquire)) {
+        // wake up regularly to notice stop()
+        pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, 200) <= 0)
+            continue;
+
+        const ssize_t length = read(fd, buffer, sizeof(buffer));
+        for (ssize_t offset = 0; offset < length;) {
+            const auto *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            if (event->len == 0)
+                continue;
+
+            // editors that save through a temporary file show up as IN_MOVED_TO
+            for (size_t i = 0; i < watched.size(); ++i) {
+                if (watched[i].fileName == event->name)
+                    load(i);
+            }
+        }
+    }
+
+    close(fd);
+}
+
+void AssetReloader::load(size_t index)
+{
+    const std::string path = directory + "/" + watched[index].fileName;
+    Reload reload = {.index = index, .image = {}, .data = nullptr, .dataSize = 0};
+
+    // only the decode happens here, GPU uploads and audio streams need the main thread
+    if (watched[index].texture) {
+        reload.image = LoadImage(path.c_str());
+        if (!IsImageValid(reload.image)) {
+            TraceLog(LOG_WARNING, "Hot reload: failed to decode %s", path.c_str());
+            return;
+        }
+    } else {
+        reload.data = LoadFileData(path.c_str(), &reload.dataSize);
+        if (!reload.data) {
+            TraceLog(LOG_WARNING, "Hot reload: failed to read %s", path.c_str());
+            return;
+        }
+    }
+
+    const std::lock_guard lock(pendingMutex);
+    // a file saved twice before the next frame only needs its newest version
+    for (Reload &other : pending) {
+        if (other.index == index) {
+            freeReload(other);
+            other = reload;
+            return;
+        }
+    }
+    pending.push_back(reload);
+}
+
+void AssetReloader::freeReload(Reload &reload)
+{
+    if (reload.image.data)
+        UnloadImage(reload.image);
+    if (reload.data)
+        UnloadFileData(reload.data);
+    reload = {};
+}
+
+void AssetReloader::apply()
+{
+    static std::vector<Reload> ready; // reused, swapped with pending
+    {
+        const std::unique_lock lock(pendingMutex, std::try_to_lock);
+        if (!lock.owns_lock() || pending.empty())
+            return; // the watcher is busy, try again next frame
+        ready.swap(pending);
+    }
+
+    for (Reload &reload : ready) {
+        Watched &entry = watched[reload.index];
+
+        if (entry.texture) {
+            const Texture2D texture = LoadTextureFromImage(reload.image);
+            UnloadImage(reload.image);
+            if (texture.id == 0) {
+                TraceLog(LOG_WARNING, "Hot reload: failed to upload %s", entry.fileName.c_str());
+                continue;
+            }
+            UnloadTexture(*entry.texture);
+            *entry.texture = texture;
+        } else {
+            Music music = LoadMusicStreamFromMemory(GetFileExtension(entry.fileName.c_str()),
+                                                    reload.data, reload.dataSize);
+            if (!IsMusicValid(music)) {
+                TraceLog(LOG_WARNING, "Hot reload: failed to open %s", entry.fileName.c_str());
+                UnloadFileData(reload.data);
+                continue;
+            }
+
+            // keep playing from the same spot
+            const bool playing = IsMusicStreamPlaying(*entry.music);
+            const float played = GetMusicTimePlayed(*entry.music);
+            music.looping = entry.music->looping;
+
+            UnloadMusicStream(*entry.music);
+            if (entry.musicData)
+                UnloadFileData(entry.musicData);
+            entry.musicData = reload.data;
+            *entry.music = music;
+
+            SetMusicVolume(music, Settings::config.musicVolume);
+            if (playing) {
+                PlayMusicStream(music);
+                SeekMusicStream(music, std::fmod(played, GetMusicTimeLength(music)));
+            }
+        }
+
+        TraceLog(LOG_INFO, "Hot reload: %s", entry.fileName.c_str());
+    }
+    ready.clear();
+}
+
+#endif // HOT_RELOAD
@@ -0,0 +1,279 @@
+#include "AttackPatterns.hpp"
+
+#include "Constants.hpp"
+#include "Random.hpp"
+#include "raylib.h"
+
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <string>
+
+std::vector<AttackPattern> AttackPatterns::patterns{};
+std::vector<PatternWave> AttackPatterns::waveTable{};
+std::vector<Vector2> AttackPatterns::directionTable{};
+std::vector<uint16_t> AttackPatterns::patternsBySize[AttackTables::SIZE_COUNT]{};
+float AttackPatterns::totalWeight[AttackTables::SIZE_COUNT]{};
+
+namespace {
+constexpr int MAX_BULLETS_PER_WAVE = 256;
+constexpr int MAX_WAVES = 64;
+
+std::string trim(const std::string &str)
+{
+    const size_t start = str.find_first_not_of(" \t\r");
+    if (start == std::string::npos)
+        return "";
+    const size_t end = str.find_last_not_of(" \t\r");
+    return str.substr(start, end - start + 1);
+}
+
+template <typename T> bool parseNumber(const std::string &value, T &out)
+{
+    const char *end = value.data() + value.size();
+    const auto [ptr, ec] = std::from_chars(value.data(), end, out);
+    return ec == std::errc() && ptr == end;
+}
+} // namespace
+
+void AttackPatterns::load(const char *path)
+{
+    clear();
+
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        TraceLog(LOG_WARNING, "Attack pattern file %s not found, using default patterns.", path);
+    } else {
+        Definition current{};
+        bool hasCurrent = false;
+        bool valid = false;
+
+        // a pattern is only compiled when its whole section parsed and validated
+        auto flush = [&]() {
+            if (hasCurrent && valid && validate(current))
+                compile(current);
+        };
+
+        std::string line;
+        int lineNumber = 0;
+
+        while (std::getline(file, line)) {
+            ++lineNumber;
+            line = trim(line);
+            if (line.empty() || line.front() == '#')
+                continue;
+
+            if (line.front() == '[') {
+                flush();
+                hasCurrent = true;
+                valid = line.back() == ']' && line.size() > 2;
+                current = {.name = line.substr(1, line.size() - 2),
+                           .line = lineNumber,
+                           .size = AttackSize::SMALL,
+                           .hasSize = false,
+                           .aimed = false,
+                           .bullets = 0,
+                           .waves = 1,
+                           .interval = 0.f,
+                           .rotate = 0.f,
+                           .spread = 30.f,
+                           .speed = 1.f,
+                           .weight = 1.f};
+                if (!valid)
+                    TraceLog(LOG_WARNING, "%s:%d: malformed pattern header", path, lineNumber);
+                continue;
+            }
+
+            const size_t pos = line.find('=');
+            if (pos == std::string::npos || !hasCurrent) {
+                TraceLog(LOG_WARNING, "%s:%d: expected key=value inside a [pattern]", path,
+                         lineNumber);
+                valid = false;
+                continue;
+            }
+
+            const std::string key = trim(line.substr(0, pos));
+            const std::string value = trim(line.substr(pos + 1));
+            if (!setKey(current, key, value)) {
+                TraceLog(LOG_WARNING, "%s:%d: invalid key or value: %s=%s", path, lineNumber,
+                         key.c_str(), value.c_str());
+                valid = false;
+            }
+        }
+        flush();
+    }
+
+    // every size needs at least one pattern, fall back to the classic ring
+    for (size_t s = 0; s < AttackTables::SIZE_COUNT; ++s) {
+        if (patternsBySize[s].empty())
+            addDefaultRing(static_cast<AttackSize>(s));
+    }
+
+    TraceLog(LOG_INFO, "Loaded %zu attack patterns (%zu waves, %zu bullet directions)",
+             patterns.size(), waveTable.size(), directionTable.size());
+}
+
+uint16_t AttackPatterns::pick(AttackSize size)
+{
+    const auto s = static_cast<size_t>(size);
+    const std::vector<uint16_t> &candidates = patternsBySize[s];
+    if (candidates.size() == 1 || totalWeight[s] <= 0.f)
+        return candidates.front();
+
+    float roll = Random::value(0, 9999) / 10000.f * totalWeight[s];
+    for (const uint16_t index : candidates) {
+        roll -= patterns[index].weight;
+        if (roll < 0.f)
+            return index;
+    }
+    return candidates.back();
+}
+
+void AttackPatterns::clear()
+{
+    patterns.clear();
+    waveTable.clear();
+    directionTable.clear();
+    for (size_t s = 0; s < AttackTables::SIZE_COUNT; ++s) {
+        patternsBySize[s].clear();
+        totalWeight[s] = 0.f;
+    }
+}
+
+bool AttackPatterns::setKey(Definition &definition,
+                            const std::string &key,
+                            const std::string &value)
+{
+    if (key == "size") {
+        definition.hasSize = true;
+        if (value == "small")
+            definition.size = AttackSize::SMALL;
+        else if (value == "medium")
+            definition.size = AttackSize::MEDIUM;
+        else if (value == "large")
+            definition.size = AttackSize::LARGE;
+        else
+            return false;
+        return true;
+    }
+    if (key == "shape") {
+        if (value != "ring" && value != "aimed")
+            return false;
+        definition.aimed = (value == "aimed");
+        return true;
+    }
+    if (key == "bullets")
+        return parseNumber(value, definition.bullets);
+    if (key == "waves")
+        return parseNumber(value, definition.waves);
+    if (key == "interval")
+        return parseNumber(value, definition.interval);
+    if (key == "rotate")
+        return parseNumber(value, definition.rotate);
+    if (key == "spread")
+        return parseNumber(value, definition.spread);
+    if (key == "speed")
+        return parseNumber(value, definition.speed);
+    if (key == "weight")
+        return parseNumber(value, definition.weight);
+
+    return false; // unknown key
+}
+
+bool AttackPatterns::validate(const Definition &definition)
+{
+    const char *error = nullptr;
+
+    if (!definition.hasSize)
+        error = "missing size";
+    else if (definition.bullets < 0 || definition.bullets > MAX_BULLETS_PER_WAVE)
+        error = "bullets must be between 1 and 256, or 0 for the size default";
+    else if (definition.waves < 1 || definition.waves > MAX_WAVES)
+        error = "waves must be between 1 and 64";
+    else if (!(definition.interval >= 0.f && definition.interval <= 10.f))
+        error = "interval must be between 0 and 10 seconds";
+    else if (!(definition.speed > 0.f && definition.speed <= 10.f))
+        error = "speed must be above 0 and at most 10";
+    else if (!(definition.spread >= 0.f && definition.spread <= 360.f))
+        error = "spread must be between 0 and 360 degrees";
+    else if (!(definition.weight >= 0.f) || !std::isfinite(definition.weight) ||
+             !std::isfinite(definition.rotate))
+        error = "weight and rotate must be finite, weight can not be negative";
+
+    if (!error) {
+        // table indices are 16 bit to keep the waves compact
+        const auto size = static_cast<size_t>(definition.size);
+        const int bullets =
+            definition.bullets > 0 ? definition.bullets : BossAttackConfig::BULLET_COUNT[size];
+        if (directionTable.size() + static_cast<size_t>(bullets * definition.waves) > UINT16_MAX ||
+            waveTable.size() + definition.waves > UINT16_MAX || patterns.size() >= UINT16_MAX)
+            error = "pattern table is full";
+    }
+
+    if (error) {
+        TraceLog(LOG_WARNING, "Pattern [%s] at line %d skipped: %s", definition.name.c_str(),
+                 definition.line, error);
+        return false;
+    }
+    return true;
+}
+
+void AttackPatterns::compile(const Definition &definition)
+{
+    const auto size = static_cast<size_t>(definition.size);
+    const int bullets =
+        definition.bullets > 0 ? definition.bullets : BossAttackConfig::BULLET_COUNT[size];
+    const float spread = definition.spread * DEG2RAD;
+
+    const AttackPattern pattern = {.firstWave = static_cast<uint16_t>(waveTable.size()),
+                                   .waveCount = static_cast<uint16_t>(definition.waves),
+                                   .weight = definition.weight};
+
+    for (int w = 0; w < definition.waves; ++w) {
+        waveTable.push_back({.time = definition.interval * w,
+                             .speedScale = definition.speed,
+                             .firstDirection = static_cast<uint16_t>(directionTable.size()),
+                             .bulletCount = static_cast<uint16_t>(bullets),
+                             .aimed = static_cast<uint8_t>(definition.aimed)});
+
+        // rings cover the full circle, aimed bursts fan out around the player direction
+        const float start = definition.rotate * DEG2RAD * w;
+        for (int i = 0; i < bullets; ++i) {
+            const float angle =
+                definition.aimed
+                    ? start + (bullets > 1 ? spread * (static_cast<float>(i) / (bullets - 1) - 0.5f)
+                                           : 0.f)
+                    : start + 2.f * PI * i / bullets;
+            directionTable.push_back({cosf(angle), sinf(angle)});
+        }
+    }
+
+    addPattern(definition.size, pattern);
+}
+
+void AttackPatterns::addPattern(AttackSize size, const AttackPattern &pattern)
+{
+    const auto s = static_cast<size_t>(size);
+    patternsBySize[s].push_back(static_cast<uint16_t>(patterns.size()));
+    totalWeight[s] += pattern.weight;
+    patterns.push_back(pattern);
+}
+
+void AttackPatterns::addDefaultRing(AttackSize size)
+{
+    // the ring directions are already precomputed at compile time
+    const AttackTables::AttackParams &params = AttackTables::params(Difficulty::NORMAL, size);
+
+    const AttackPattern pattern = {.firstWave = static_cast<uint16_t>(waveTable.size()),
+                                   .waveCount = 1,
+                                   .weight = 1.f};
+    waveTable.push_back({.time = 0.f,
+                         .speedScale = 1.f,
+                         .firstDirection = static_cast<uint16_t>(directionTable.size()),
+                         .bulletCount = static_cast<uint16_t>(params.bulletCount),
+                         .aimed = 0});
+    directionTable.insert(directionTable.end(), params.directions,
+                          params.directions + params.bulletCount);
+
+    addPattern(size, pattern);
+}
@@ -0,0 +1,72 @@
+#include "Benchmark.hpp"
+
+#include "Game.hpp"
+#include "GlobalBounds.hpp"
+#include "Random.hpp"
+#include "raylib.h"
+
+#include <algorithm>
+#include <numeric>
+
+int Benchmark::frameLimit = 0;
+std::vector<float> Benchmark::frameTimes{};
+std::chrono::steady_clock::time_point Benchmark::frameStart{};
+uint32_t Benchmark::runs = 0;
+
+namespace {
+constexpr int RETARGET_FRAMES = 30; // the bot picks a new destination twice a second
+} // namespace
+
+void Benchmark::start(int frames)
+{
+    frameLimit = std::max(frames, 1);
+    frameTimes.reserve(frameLimit);
+    TraceLog(LOG_INFO, "Benchmark: %d frames at a fixed %.4f s step", frameLimit, FRAME_TIME);
+}
+
+void Benchmark::beginFrame(Game &game)
+{
+    // a lost or won run starts over right away, the workload never sits in a menu
+    if (game.getGameState() != GameState::PLAYING) {
+        game.reset();
+        game.setGameState(GameState::PLAYING);
+        ++runs;
+    }
+
+    if (frameTimes.size() % RETARGET_FRAMES == 0 && game.player) {
+        game.player->setMoveTarget(
+            {static_cast<float>(Random::value(movementBounds.left, movementBounds.right)),
+             static_cast<float>(Random::value(movementBounds.top, movementBounds.bottom))});
+    }
+
+    frameStart = std::chrono::steady_clock::now();
+}
+
+void Benchmark::endFrame(Game &game)
+{
+    const std::chrono::duration<float, std::milli> elapsed =
+        std::chrono::steady_clock::now() - frameStart;
+    frameTimes.push_back(elapsed.count());
+
+    if (static_cast<int>(frameTimes.size()) >= frameLimit) {
+        report();
+        game.shouldClose = true;
+    }
+}
+
+void Benchmark::report()
+{
+    std::vector<float> sorted = frameTimes;
+    std::ranges::sort(sorted);
+    const float total = std::accumulate(sorted.begin(), sorted.end(), 0.f);
+    const auto at = [&sorted](float fraction) {
+        return sorted[static_cast<size_t>(fraction * (sorted.size() - 1))];
+    };
+
+    // single line with stable keys, build.sh --pgo parses mean_ms
+    TraceLog(LOG_INFO,
+             "BENCHMARK frames=%zu runs=%u total_s=%.3f mean_ms=%.4f p50_ms=%.4f p99_ms=%.4f "
+             "max_ms=%.4f",
+             sorted.size(), runs, total / 1000.f, total / sorted.size(), at(0.5f), at(0.99f),
+             sorted.back());
+}
@@ -2,14 +2,28 @@
 
 #include "Constants.hpp"
 #include "Game.hpp"
+#include "QualityGovernor.hpp"
+#include "Sfx.hpp"
 #include "raylib.h"
 
 #include <cmath>
 
-Bomb::Bomb(const Texture2D &texture, Vector2 position)
-    : position(position), texture(texture), expireTime(Game::gameTime + BOMB_LIFETIME),
-      currentScale(1.0f)
+Bomb::Bomb(const Texture2D &texture, Vector2 position) : texture(texture)
 {
+    init(position);
+}
+
+Bomb::Bomb(const Texture2D &texture, StateReader &reader) : texture(texture)
+{
+    load(reader);
+}
+
+void Bomb::init(Vector2 newPosition)
+{
+    position = newPosition;
+    alive = true;
+    expireTimer = TimerWheel::schedule(BOMB_LIFETIME, onExpireTimer, this);
+    currentScale = 1.0f;
 }
 
 void Bomb::draw() const
@@ -17,7 +31,7 @@ void Bomb::draw() const
     if (!isAlive())
         return;
 
-    const float scale = currentScale;
+    const float scale = QualityGovernor::bombPulse() ? currentScale : 1.0f;
     const Vector2 origin = {BOMB_SIZE / 2.f * scale, BOMB_SIZE / 2.f * scale};
 
     const Rectangle src = {0, 0, static_cast<float>(texture.width),
@@ -31,7 +45,7 @@ void Bomb::draw() const
 #endif
 }
 
-void Bomb::update(const Player &player, Boss &boss, float deltaTime)
+void Bomb::update(const Player &player, const Player *partner, Boss &boss, float deltaTime)
 {
     if (!isAlive())
         return;
@@ -41,20 +55,48 @@ void Bomb::update(const Player &player, Boss &boss, float deltaTime)
     animTime += deltaTime * 5.0f;
     currentScale = 1.0f + sinf(animTime) * 0.1f;
 
-    if (CheckCollisionCircles(position, BOMB_COLLISION_RADIUS, player.position,
-                              PLAYER_COLLISION_RADIUS)) {
+    // a downed co-op player can't pick it up, alone the run ends with this tick anyway
+    const auto touches = [this, partner](const Player &target) {
+        return (!partner || target.health > 0.f) &&
+               CheckCollisionCircles(position, BOMB_COLLISION_RADIUS, target.position,
+                                     PLAYER_COLLISION_RADIUS);
+    };
+    if (touches(player) || (partner && touches(*partner))) {
         TraceLog(LOG_INFO, "Bomb exploded at: (%f, %f)", position.x, position.y);
         explode(boss);
     }
 }
 
+void Bomb::save(StateWriter &writer) const
+{
+    writer.write(position);
+    writer.write(alive);
+    writer.write(TimerWheel::due(expireTimer));
+}
+
+void Bomb::load(StateReader &reader)
+{
+    position = reader.read<Vector2>();
+    alive = reader.read<bool>();
+    const auto due = reader.read<TimerDue>();
+    expireTimer = due.tick != 0 ? TimerWheel::scheduleAt(due, onExpireTimer, this) : TimerId{};
+    currentScale = 1.0f;
+}
+
+void Bomb::onExpireTimer(void *self)
+{
+    static_cast<Bomb *>(self)->alive = false;
+}
+
 bool Bomb::isAlive() const
 {
-    return (Game::gameTime < expireTime);
+    return alive;
 }
 
 void Bomb::explode(Boss &boss)
 {
+    Sfx::play(SfxId::BOMB_PICKUP);
     boss.takeDamage(BOMB_DAMAGE);
-    expireTime = 0.f;
+    alive = false;
+    TimerWheel::cancel(expireTimer);
 }
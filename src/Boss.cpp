@@ -3,6 +3,7 @@
 #include "Constants.hpp"
 #include "Difficulty.hpp"
 #include "Game.hpp"
+#include "Sfx.hpp"
 #include "raylib.h"
 
 #include <cmath>
@@ -18,11 +19,12 @@ Boss::Boss(const Texture2D &texture, const Texture2D &lareiTexture)
 void Boss::init()
 {
     health = BOSS_HEALTH;
+    phase = BossPhase::CALM;
 }
 
 void Boss::draw() const
 {
-    const auto screenWidth = static_cast<float>(GetScreenWidth());
+    constexpr auto screenWidth = static_cast<float>(SCREEN_WIDTH);
 
     DrawTexturePro(
         texture, {0.f, 0.f, static_cast<float>(texture.width), static_cast<float>(texture.height)},
@@ -32,36 +34,62 @@ void Boss::draw() const
                               (BOSS_HEIGHT - lareiTexture.height) * 0.5f};
     DrawTextureV(lareiTexture, lareiPos, WHITE);
 
-    const float healthWidth = (GetScreenWidth() - 40.f) * (health / BOSS_HEALTH);
+    const float healthWidth = (screenWidth - 40.f) * (health / BOSS_HEALTH);
     DrawRectangle(20, BOSS_HEIGHT - 15, healthWidth, 10, RED);
-    DrawRectangleLines(20, BOSS_HEIGHT - 15, GetScreenWidth() - 40, 10, DARKGRAY);
+    DrawRectangleLines(20, BOSS_HEIGHT - 15, SCREEN_WIDTH - 40, 10, DARKGRAY);
 }
 
 void Boss::update(float deltaTime)
 {
     animTime += deltaTime;
 
-    float animSpeed = 3.f;
+    constexpr float animSpeeds[] = {3.f, 8.f, 12.f}; // indexed by BossPhase
     constexpr float animOffset = 5.f;
 
-    if (health < BOSS_HEALTH * 0.3f) {
-        animSpeed = 12.f;
-    } else if (health < BOSS_HEALTH * 0.6f) {
-        animSpeed = 8.f;
-    }
-
-    lareiOffsetX = sinf(animTime * animSpeed) * animOffset;
+    lareiOffsetX = sinf(animTime * animSpeeds[static_cast<size_t>(phase)]) * animOffset;
 
     // if health is less than 30% and difficulty is HARD
     // regenerate health
-    if (health < BOSS_HEALTH * 0.3f && currentDifficulty == Difficulty::HARD)
+    if (phase == BossPhase::ENRAGED && currentDifficulty == Difficulty::HARD)
         health += deltaTime * 0.5f;
 }
 
+void Boss::setPhase(BossPhase newPhase)
+{
+    if (newPhase == phase)
+        return;
+    TraceLog(LOG_INFO, "Boss phase: %d -> %d", static_cast<int>(phase), static_cast<int>(newPhase));
+    phase = newPhase;
+}
+
+void Boss::save(StateWriter &writer) const
+{
+    writer.write(health);
+    writer.write(phase);
+    writer.write(animTime);
+}
+
+void Boss::load(StateReader &reader)
+{
+    health = reader.read<float>();
+    phase = reader.read<BossPhase>();
+    animTime = reader.read<float>();
+}
+
+BossPhase Boss::phaseForHealth() const
+{
+    if (health < BOSS_HEALTH * 0.3f)
+        return BossPhase::ENRAGED;
+    if (health < BOSS_HEALTH * 0.6f)
+        return BossPhase::ANGRY;
+    return BossPhase::CALM;
+}
+
 void Boss::takeDamage(float damage)
 {
     health = std::fmax(health - damage, 0.0f);
     TraceLog(LOG_INFO, "Boss took damage: %.0f, remaining health: %.0f", damage, health);
+    Sfx::play(SfxId::BOSS_HIT);
 
     // shake the window
     game.shakeWindow(0.5f, 10.f);
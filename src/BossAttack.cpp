@@ -1,108 +1,263 @@
 #include "BossAttack.hpp"
 
+#include "AttackPatterns.hpp"
+#include "Collision.hpp"
 #include "Constants.hpp"
 #include "Difficulty.hpp"
 #include "Game.hpp"
+#include "Survival.hpp"
+#include "TimerWheel.hpp"
+#include "raymath.h"
 
 #include <algorithm>
 #include <cmath>
-#include <memory>
 
-float getAttackSizeRadius(AttackSize size)
+BossAttack::BossAttack(Vector2 position, AttackSize size)
 {
-    switch (size) {
-        case AttackSize::SMALL:
-            return 25.f;
-        case AttackSize::MEDIUM:
-            return 30.f;
-        case AttackSize::LARGE:
-            return 50.f;
-        default:
-            return 0.f;
-    }
+    init(position, size);
 }
 
-BossAttack::BossAttack(Vector2 position, AttackSize size)
-    : position(position), size(size), explodeTime(0.f), exploded(false)
+BossAttack::BossAttack(StateReader &reader)
 {
-    const float factor = (currentDifficulty == Difficulty::EASY) ? BossAttackConfig::EASY_FACTOR
-                         : (currentDifficulty == Difficulty::NORMAL)
-                             ? BossAttackConfig::NORMAL_FACTOR
-                             : BossAttackConfig::HARD_FACTOR;
-    explodeTime = Game::gameTime +
-                  (size == AttackSize::SMALL
-                       ? BossAttackConfig::SMALL_EXPLODE_TIME
-                       : (size == AttackSize::MEDIUM ? BossAttackConfig::MEDIUM_EXPLODE_TIME
-                                                     : BossAttackConfig::LARGE_EXPLODE_TIME)) *
-                      factor;
+    load(reader);
+}
+
+void BossAttack::init(Vector2 newPosition, AttackSize newSize)
+{
+    position = newPosition;
+    size = newSize;
+    exploded = false;
+    params = &AttackTables::params(currentDifficulty, size);
+    explodeTime = Game::gameTime + params->explodeDelay;
+    // a pooled attack is only reused once it's dead, so its timer always fired before
+    explodeTimer = TimerWheel::schedule(params->explodeDelay, onExplodeTimer, this);
+    bulletsExpireTime = 0.f;
+
+    const AttackPattern &pattern = AttackPatterns::pattern(AttackPatterns::pick(size));
+    nextWave = pattern.firstWave;
+    waveEnd = pattern.firstWave + pattern.waveCount;
+    bulletRepeat = static_cast<uint16_t>(Survival::bulletRepeat());
+
+    // recycled attacks keep the capacity of their containers
+    bullets.clear();
+    predictedHits.clear();
 }
 
 void BossAttack::draw() const
 {
-    if (!exploded) {
-        const Color color = (size == AttackSize::SMALL)    ? RED
-                            : (size == AttackSize::MEDIUM) ? YELLOW
-                                                           : BLUE;
-        const float radius = getAttackSizeRadius(size);
-        DrawCircleLines(position.x, position.y, radius, color);
-    }
+    if (!exploded)
+        DrawCircleLines(position.x, position.y, params->radius, params->color);
     for (const auto &bullet : bullets)
-        bullet->draw();
+        bullet.draw();
 }
 
 bool BossAttack::isAlive() const
 {
-    return !exploded || !bullets.empty();
+    // spent predicted bullets stay until the last one left the screen but aren't saved, the
+    // expire time keeps a loaded attack alive exactly as long
+    if (HitPredictor::enabled)
+        return !exploded || nextWave < waveEnd || Game::gameTime < bulletsExpireTime;
+    return !exploded || nextWave < waveEnd || !bullets.empty();
 }
 
-void BossAttack::update(Player &player)
+void BossAttack::update(Player &player, Player *partner)
 {
-    if (!exploded && Game::gameTime > explodeTime)
-        explode();
-
-    const auto screenWidth = static_cast<float>(GetScreenWidth());
-    const auto screenHeight = static_cast<float>(GetScreenHeight());
-
-    for (const auto &bullet : bullets) {
-        bullet->update(GetFrameTime());
-        if (bullet->active && CheckCollisionCircles(bullet->position, BULLET_SIZE, player.position,
-                                                    PLAYER_COLLISION_RADIUS)) {
-            TraceLog(LOG_INFO, "Bullet hit player at: (%f, %f)", bullet->position.x,
-                     bullet->position.y);
-            player.takeDamage(5.f);
-            bullet->active = false;
+    if (!exploded)
+        return; // waiting for its timer, nothing to do yet
+    if (nextWave < waveEnd)
+        emitWaves(player.health > 0.f || !partner ? player.position : partner->position);
+
+    if (HitPredictor::enabled) {
+        updatePredicted(player);
+        return;
+    }
+
+    constexpr auto screenWidth = static_cast<float>(SCREEN_WIDTH);
+    constexpr auto screenHeight = static_cast<float>(SCREEN_HEIGHT);
+    const float deltaTime = Game::deltaTime;
+
+    // test the whole segment every bullet travelled against the player's own movement
+    // of this frame, so low frame rates and hitches can't make bullets tunnel through. a
+    // downed co-op player can't be hit, alone the run ends with this tick anyway
+    const auto hits = [partner](Vector2 bulletStart, const Bullet &bullet, const Player &target) {
+        const Vector2 targetEnd = target.position;
+        const Vector2 targetStart = {targetEnd.x - target.velocity.x,
+                                     targetEnd.y - target.velocity.y};
+        return (!partner || target.health > 0.f) &&
+               checkSweptCircles(bulletStart, bullet.position, targetStart, targetEnd,
+                                 BULLET_SIZE + PLAYER_COLLISION_RADIUS);
+    };
+
+    for (auto &bullet : bullets) {
+        if (!bullet.active)
+            continue;
+
+        const Vector2 bulletStart = bullet.position;
+        bullet.update(deltaTime);
+
+        Player *hit = nullptr;
+        if (hits(bulletStart, bullet, player))
+            hit = &player;
+        else if (partner && hits(bulletStart, bullet, *partner))
+            hit = partner;
+        if (hit) {
+            TraceLog(LOG_INFO, "Bullet hit player at: (%f, %f)", bullet.position.x,
+                     bullet.position.y);
+            hit->takeDamage(5.f);
+            bullet.active = false;
         }
-        if (bullet->position.x < 0 || bullet->position.x > screenWidth || bullet->position.y < 0 ||
-            bullet->position.y > screenHeight) {
-            bullet->active = false;
+        if (bullet.position.x < 0 || bullet.position.x > screenWidth || bullet.position.y < 0 ||
+            bullet.position.y > screenHeight) {
+            bullet.active = false;
         }
     }
 
     // remove inactive bullets
-    std::erase_if(bullets, [](const auto &bullet) { return !bullet->active; });
+    std::erase_if(bullets, [](const auto &bullet) { return !bullet.active; });
 }
 
 void BossAttack::explode()
 {
+    // the bullets are emitted by the pattern waves, starting on this tick. the wheel works
+    // in whole milliseconds, the first wave must not wait for the next frame because of it
     exploded = true;
-    const int bulletCount = (size == AttackSize::SMALL)    ? BossAttackConfig::SMALL_BULLET_COUNT
-                            : (size == AttackSize::MEDIUM) ? BossAttackConfig::MEDIUM_BULLET_COUNT
-                                                           : BossAttackConfig::LARGE_BULLET_COUNT;
-    const float factor = (currentDifficulty == Difficulty::EASY) ? BossAttackConfig::EASY_FACTOR
-                         : (currentDifficulty == Difficulty::NORMAL)
-                             ? BossAttackConfig::NORMAL_FACTOR
-                             : BossAttackConfig::HARD_FACTOR;
-    const float bulletSpeed =
-        ((size == AttackSize::SMALL)    ? BossAttackConfig::SMALL_BULLET_SPEED
-         : (size == AttackSize::MEDIUM) ? BossAttackConfig::MEDIUM_BULLET_SPEED
-                                        : BossAttackConfig::LARGE_BULLET_SPEED) *
-        factor;
-    const float angleStep = 360.0f / bulletCount;
-
-    for (int i = 0; i < bulletCount; i++) {
-        const float angle = angleStep * i;
-        Vector2 dir = {cosf(DEG2RAD * angle), sinf(DEG2RAD * angle)};
-        bullets.emplace_back(std::make_unique<Bullet>(
-            Vector2{position.x + dir.x, position.y + dir.y}, dir, bulletSpeed));
+    explodeTime = std::fmin(explodeTime, Game::gameTime);
+}
+
+void BossAttack::save(StateWriter &writer) const
+{
+    writer.write(position);
+    writer.write(size);
+    writer.write(explodeTime);
+    writer.write(exploded);
+    writer.write(nextWave);
+    writer.write(waveEnd);
+    writer.write(bulletRepeat);
+    writer.write(bulletsExpireTime);
+    writer.write(TimerWheel::due(explodeTimer));
+    // spent bullets are left out and the predicted hits are solved again on load
+    writer.write(static_cast<uint32_t>(std::ranges::count_if(bullets, &Bullet::active)));
+    for (const auto &bullet : bullets)
+        if (bullet.active)
+            bullet.save(writer);
+}
+
+void BossAttack::load(StateReader &reader)
+{
+    position = reader.read<Vector2>();
+    size = reader.read<AttackSize>();
+    params = &AttackTables::params(currentDifficulty, size);
+    explodeTime = reader.read<float>();
+    exploded = reader.read<bool>();
+    nextWave = reader.read<uint16_t>();
+    waveEnd = reader.read<uint16_t>();
+    bulletRepeat = reader.read<uint16_t>();
+    bulletsExpireTime = reader.read<float>();
+    const auto due = reader.read<TimerDue>();
+    explodeTimer = due.tick != 0 ? TimerWheel::scheduleAt(due, onExplodeTimer, this) : TimerId{};
+    bullets.clear();
+    for (auto count = reader.read<uint32_t>(); count > 0 && !reader.hasFailed(); --count)
+        bullets.emplace_back().load(reader);
+
+    // the live run solved each hit at the later of the spawn and the last path change,
+    // solving from there again gives the same times bit for bit
+    predictedHits.clear();
+    if (HitPredictor::enabled) {
+        for (size_t i = 0; i < bullets.size(); ++i) {
+            const float from = std::fmax(bullets[i].spawnTime, HitPredictor::path.time);
+            const float hitTime = HitPredictor::solve(bullets[i], from);
+            if (std::isfinite(hitTime))
+                predictedHits.push_back({hitTime, static_cast<uint32_t>(i)});
+        }
+        std::make_heap(predictedHits.begin(), predictedHits.end());
+    }
+}
+
+void BossAttack::onExplodeTimer(void *self)
+{
+    static_cast<BossAttack *>(self)->explode();
+}
+
+void BossAttack::emitWaves(Vector2 target)
+{
+    const float elapsed = Game::gameTime - explodeTime;
+    const PatternWave *waves = AttackPatterns::waves();
+    const Vector2 *directions = AttackPatterns::directions();
+
+    while (nextWave < waveEnd && waves[nextWave].time <= elapsed) {
+        const PatternWave &wave = waves[nextWave++];
+        const float bulletSpeed = params->bulletSpeed * wave.speedScale;
+
+        // aimed waves are rotated towards the player, rings keep their directions
+        Vector2 aim = {1.f, 0.f};
+        const Vector2 toTarget = Vector2Subtract(target, position);
+        if (wave.aimed && Vector2LengthSqr(toTarget) > 0.f)
+            aim = Vector2Normalize(toTarget);
+
+        // survival copies fill the gaps between the directions of the wave
+        const float copyAngle = 2.f * PI / static_cast<float>(wave.bulletCount * bulletRepeat);
+        for (uint16_t copy = 0; copy < bulletRepeat; ++copy) {
+            const Vector2 offset = {std::cos(copyAngle * copy), std::sin(copyAngle * copy)};
+            const Vector2 copyAim = {aim.x * offset.x - aim.y * offset.y,
+                                     aim.x * offset.y + aim.y * offset.x};
+
+            for (const Vector2 *dir = directions + wave.firstDirection,
+                               *end = dir + wave.bulletCount;
+                 dir != end; ++dir) {
+                const Vector2 rotated = {dir->x * copyAim.x - dir->y * copyAim.y,
+                                         dir->x * copyAim.y + dir->y * copyAim.x};
+                const Bullet &bullet = bullets.emplace_back(
+                    Vector2{position.x + rotated.x, position.y + rotated.y}, rotated, bulletSpeed);
+
+                if (HitPredictor::enabled) {
+                    bulletsExpireTime = std::fmax(bulletsExpireTime, bullet.expireTime);
+                    const float hitTime = HitPredictor::solve(bullet, Game::gameTime);
+                    if (std::isfinite(hitTime)) {
+                        predictedHits.push_back(
+                            {hitTime, static_cast<uint32_t>(bullets.size() - 1)});
+                        std::push_heap(predictedHits.begin(), predictedHits.end());
+                    }
+                }
+            }
+        }
+    }
+}
+
+void BossAttack::updatePredicted(Player &player)
+{
+    const float now = Game::gameTime;
+
+    // the player left the predicted path, solve every remaining bullet again.
+    // this comes first, hits due on the old path may no longer happen on the new one
+    if (HitPredictor::pathChanged) {
+        predictedHits.clear();
+        for (size_t i = 0; i < bullets.size(); ++i) {
+            if (!bullets[i].active)
+                continue;
+            const float hitTime = HitPredictor::solve(bullets[i], now);
+            if (std::isfinite(hitTime))
+                predictedHits.push_back({hitTime, static_cast<uint32_t>(i)});
+        }
+        std::make_heap(predictedHits.begin(), predictedHits.end());
+    }
+
+    // the heap head is the only thing checked on a quiet frame
+    while (!predictedHits.empty() && predictedHits.front().time <= now) {
+        std::pop_heap(predictedHits.begin(), predictedHits.end());
+        Bullet &bullet = bullets[predictedHits.back().bullet];
+        predictedHits.pop_back();
+
+        if (!bullet.active)
+            continue;
+        const Vector2 hitPosition = bullet.positionAt(now);
+        TraceLog(LOG_INFO, "Bullet hit player at: (%f, %f)", hitPosition.x, hitPosition.y);
+        player.takeDamage(5.f);
+        bullet.active = false;
+    }
+
+    // every bullet of an attack has left the screen, no need to erase them one by one
+    if (exploded && nextWave >= waveEnd && now >= bulletsExpireTime) {
+        bullets.clear();
+        predictedHits.clear();
     }
 }
@@ -1,12 +1,32 @@
 #include "Bullet.hpp"
 
 #include "Constants.hpp"
+#include "Game.hpp"
+#include "HitPredictor.hpp"
+#include "QualityGovernor.hpp"
 #include "raymath.h"
 
+#include <cmath>
+
 Bullet::Bullet(Vector2 position, Vector2 direction, float speed)
-    : active(true), position(position), direction(Vector2Normalize(direction))
+    : active(true), position(position), spawnTime(Game::gameTime), spawnPosition(position)
 {
     velocity = Vector2Scale(direction, speed * DEFAULT_GAME_FPS); // direction * speed
+    updateExpireTime();
+}
+
+void Bullet::updateExpireTime()
+{
+    // bullets never change course, so the time they leave the screen is known upfront
+    const auto exitTime = [](float pos, float vel, float max) {
+        if (vel > 0.f)
+            return (max - pos) / vel;
+        if (vel < 0.f)
+            return -pos / vel;
+        return INFINITY;
+    };
+    expireTime = spawnTime + std::fmin(exitTime(spawnPosition.x, velocity.x, SCREEN_WIDTH),
+                                       exitTime(spawnPosition.y, velocity.y, SCREEN_HEIGHT));
 }
 
 void Bullet::update(float deltaTime)
@@ -18,8 +38,8 @@ void Bullet::update(float deltaTime)
     position.y += velocity.y * deltaTime;
 
     // check if bullet is out of bounds
-    if (position.x < 0 || position.x > GetScreenWidth() || position.y < 0 ||
-        position.y > GetScreenHeight()) {
+    if (position.x < 0 || position.x > SCREEN_WIDTH || position.y < 0 ||
+        position.y > SCREEN_HEIGHT) {
         active = false;
     }
 }
@@ -27,6 +47,52 @@ void Bullet::update(float deltaTime)
 void Bullet::draw() const
 {
     if (active) {
-        DrawCircleV(position, BULLET_SIZE, Color{230, 41, 55, 200}); // translucent red
+        // predicted bullets are never stepped, their position comes from the spawn time
+        const Vector2 at = HitPredictor::enabled ? positionAt(Game::gameTime) : position;
+        constexpr Color color = {230, 41, 55, 200}; // translucent red
+        if (QualityGovernor::simpleBullets())
+            DrawRectangleV({at.x - BULLET_SIZE, at.y - BULLET_SIZE},
+                           {BULLET_SIZE * 2.f, BULLET_SIZE * 2.f}, color);
+        else
+            DrawCircleV(at, BULLET_SIZE, color);
+    }
+}
+
+Vector2 Bullet::positionAt(float time) const
+{
+    const float elapsed = time - spawnTime;
+    return {spawnPosition.x + velocity.x * elapsed, spawnPosition.y + velocity.y * elapsed};
+}
+
+Vector2 Bullet::getVelocity() const
+{
+    return velocity;
+}
+
+void Bullet::save(StateWriter &writer) const
+{
+    // stepped bullets only need where they are, predicted ones where they started
+    writer.write(velocity);
+    if (HitPredictor::enabled) {
+        writer.write(spawnPosition);
+        writer.write(spawnTime);
+    } else {
+        writer.write(position);
+    }
+}
+
+void Bullet::load(StateReader &reader)
+{
+    active = true;
+    velocity = reader.read<Vector2>();
+    if (HitPredictor::enabled) {
+        spawnPosition = reader.read<Vector2>();
+        spawnTime = reader.read<float>();
+        position = positionAt(Game::gameTime);
+    } else {
+        position = reader.read<Vector2>();
+        spawnPosition = position;
+        spawnTime = Game::gameTime;
     }
+    updateExpireTime();
 }
@@ -0,0 +1,68 @@
+#include "FrameArena.hpp"
+
+#include "raylib.h"
+
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+alignas(std::max_align_t) unsigned char FrameArena::buffer[CAPACITY];
+size_t FrameArena::offset = 0;
+size_t FrameArena::peakOffset = 0;
+size_t FrameArena::overflowCount = 0;
+
+namespace {
+#ifdef DEBUG_MODE
+// released arena memory is filled with this so stale pointers show up immediately
+constexpr unsigned char POISON_BYTE = 0xDD;
+#endif
+} // namespace
+
+void *FrameArena::allocate(size_t size, size_t alignment)
+{
+    const size_t start = (offset + alignment - 1) & ~(alignment - 1);
+    if (start + size > CAPACITY) {
+        // never fail, but make the overflow visible so the capacity can be tuned
+        if (overflowCount++ == 0)
+            TraceLog(LOG_WARNING, "Frame arena exhausted (%zu bytes), falling back to heap",
+                     CAPACITY);
+        return ::operator new(size, std::align_val_t{alignment});
+    }
+
+    offset = start + size;
+    if (offset > peakOffset)
+        peakOffset = offset;
+    return buffer + start;
+}
+
+void FrameArena::deallocate(void *ptr, size_t size, size_t alignment)
+{
+    if (!owns(ptr)) {
+        ::operator delete(ptr, std::align_val_t{alignment});
+        return;
+    }
+
+#ifdef DEBUG_MODE
+    std::memset(ptr, POISON_BYTE, size);
+#endif
+
+    // the newest allocation can be given back right away, e.g. a vector growing in place
+    if (static_cast<unsigned char *>(ptr) + size == buffer + offset)
+        offset -= size;
+}
+
+void FrameArena::reset()
+{
+#ifdef DEBUG_MODE
+    std::memset(buffer, POISON_BYTE, offset);
+#endif
+    offset = 0;
+    overflowCount = 0;
+}
+
+bool FrameArena::owns(const void *ptr)
+{
+    const auto address = reinterpret_cast<uintptr_t>(ptr);
+    const auto begin = reinterpret_cast<uintptr_t>(buffer);
+    return address >= begin && address < begin + CAPACITY;
+}
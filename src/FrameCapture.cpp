@@ -0,0 +1,360 @@
+#include "FrameCapture.hpp"
+
+#include "Constants.hpp"
+#include "Profiler.hpp"
+#include "Settings.hpp"
+#include "raylib.h"
+#include "rlgl.h"
+
+// raylib loads the GL functions through glad, the pointers are shared with it. glad would
+// pull in windows.h for APIENTRY, which clashes with raylib
+#if defined(_WIN32) && !defined(APIENTRY)
+#define APIENTRY __stdcall
+#endif
+#include "external/glad.h"
+
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <utility>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#define PIPE_MODE "wb"
+#else
+#define PIPE_MODE "w"
+#endif
+
+bool FrameCapture::capturing = false;
+FrameCapture::Format FrameCapture::format = FrameCapture::Format::Y4M;
+FILE *FrameCapture::output = nullptr;
+bool FrameCapture::isPipe = false;
+int FrameCapture::framesPerSecond = CAPTURE_DEFAULT_FPS;
+float FrameCapture::captureClock = 0.f;
+float FrameCapture::elapsed = 0.f;
+RenderTexture2D FrameCapture::copy{};
+std::array<unsigned int, FrameCapture::PBO_COUNT> FrameCapture::pbos{};
+std::array<void *, FrameCapture::PBO_COUNT> FrameCapture::fences{};
+size_t FrameCapture::nextPbo = 0;
+std::array<std::vector<uint8_t>, FrameCapture::QUEUE_FRAMES> FrameCapture::frames{};
+std::array<size_t, FrameCapture::QUEUE_FRAMES> FrameCapture::freeFrames{};
+size_t FrameCapture::freeCount = 0;
+std::array<size_t, FrameCapture::QUEUE_FRAMES> FrameCapture::readyFrames{};
+size_t FrameCapture::readyFirst = 0;
+size_t FrameCapture::readyCount = 0;
+bool FrameCapture::stopping = false;
+std::mutex FrameCapture::mutex{};
+std::condition_variable FrameCapture::wake{};
+std::thread FrameCapture::worker{};
+std::vector<std::future<void>> FrameCapture::closing{};
+uint32_t FrameCapture::captured = 0;
+uint32_t FrameCapture::dropped = 0;
+std::atomic<uint32_t> FrameCapture::written{0};
+std::atomic<bool> FrameCapture::failed{false};
+
+namespace {
+constexpr size_t FRAME_BYTES = size_t{SCREEN_WIDTH} * SCREEN_HEIGHT * 4;
+} // namespace
+
+bool FrameCapture::start(const std::string &path, int fps)
+{
+    // the queue is shared with the last recording, its worker is done once the queue is
+    // written. only its output may still be closing
+    stop();
+    if (worker.joinable())
+        worker.join();
+    std::erase_if(closing, [](const std::future<void> &task) {
+        return task.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    });
+    if (!glFenceSync || !glMapBufferRange) {
+        TraceLog(LOG_WARNING, "Capture: the GL driver has no pixel buffers");
+        return false;
+    }
+
+    isPipe = !path.empty() && path[0] == '|';
+    if (isPipe) {
+#ifndef _WIN32
+        // an encoder that quits must not take the game with it, the write fails instead
+        std::signal(SIGPIPE, SIG_IGN);
+#endif
+        output = popen(path.c_str() + 1, PIPE_MODE);
+        format = Format::Y4M;
+    } else {
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+        output = std::fopen(path.c_str(), "wb");
+        format = path.ends_with(".y4m") ? Format::Y4M : Format::RAW;
+    }
+    if (!output) {
+        TraceLog(LOG_WARNING, "Capture: can't open %s", path.c_str());
+        return false;
+    }
+
+    copy = LoadRenderTexture(SCREEN_WIDTH, SCREEN_HEIGHT);
+    glGenBuffers(PBO_COUNT, pbos.data());
+    for (const unsigned int pbo : pbos) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, FRAME_BYTES, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    fences.fill(nullptr);
+    nextPbo = 0;
+
+    // every buffer is allocated up front, recording doesn't allocate per frame
+    for (size_t i = 0; i < QUEUE_FRAMES; ++i) {
+        frames[i].resize(FRAME_BYTES);
+        freeFrames[i] = i;
+    }
+    freeCount = QUEUE_FRAMES;
+    readyFirst = 0;
+    readyCount = 0;
+    stopping = false;
+
+    framesPerSecond = std::max(fps, 1);
+    captureClock = 1.f / framesPerSecond; // the first frame is taken right away
+    elapsed = 0.f;
+    captured = 0;
+    dropped = 0;
+    written.store(0, std::memory_order_relaxed);
+    failed.store(false, std::memory_order_relaxed);
+
+    if (format == Format::Y4M)
+        std::fprintf(output, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", SCREEN_WIDTH,
+                     SCREEN_HEIGHT, framesPerSecond);
+    else
+        TraceLog(LOG_INFO, "Capture: raw RGBA frames, %dx%d at %d fps", SCREEN_WIDTH,
+                 SCREEN_HEIGHT, framesPerSecond);
+
+    worker = std::thread(work);
+    capturing = true;
+    TraceLog(LOG_INFO, "Capture: recording to %s", path.c_str());
+    return true;
+}
+
+void FrameCapture::stop()
+{
+    if (!capturing)
+        return;
+    capturing = false;
+
+    // the readbacks still in flight are waited for, in the order they were made
+    for (size_t i = 0; i < PBO_COUNT; ++i)
+        collect((nextPbo + i) % PBO_COUNT, true);
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+
+    // the GL objects go on this thread, the worker writes the rest and closes the output
+    glDeleteBuffers(PBO_COUNT, pbos.data());
+    UnloadRenderTexture(copy);
+    copy = {};
+}
+
+void FrameCapture::shutdown()
+{
+    stop();
+    if (worker.joinable())
+        worker.join();
+    closing.clear(); // waits for the outputs
+}
+
+std::string FrameCapture::defaultPath()
+{
+    return Settings::getConfigPath(TextFormat(CAPTURE_DIR "/capture-%lld.y4m",
+                                              static_cast<long long>(std::time(nullptr))));
+}
+
+void FrameCapture::capture(const Texture2D &frame)
+{
+    if (!capturing)
+        return;
+    if (failed.load(std::memory_order_relaxed)) {
+        TraceLog(LOG_WARNING, "Capture: the output stopped taking frames");
+        stop();
+        return;
+    }
+
+    // the video has a fixed rate, higher frame rates are thinned out and lower ones play
+    // back faster
+    const float interval = 1.f / framesPerSecond;
+    elapsed += GetFrameTime();
+    captureClock = std::min(captureClock + GetFrameTime(), interval * 2.f);
+    if (captureClock < interval)
+        return;
+    captureClock -= interval;
+
+    PROFILE_ZONE("capture");
+    // drawn without the flip of the window blit, so the rows read back top to bottom
+    BeginTextureMode(copy);
+    DrawTexturePro(frame,
+                   {0.f, 0.f, static_cast<float>(frame.width), static_cast<float>(frame.height)},
+                   {0.f, 0.f, SCREEN_WIDTH, SCREEN_HEIGHT}, {0.f, 0.f}, 0.f, WHITE);
+    EndTextureMode();
+
+    // the buffer comes around again PBO_COUNT frames later, its frame is long done by now
+    const size_t pbo = nextPbo;
+    nextPbo = (nextPbo + 1) % PBO_COUNT;
+    collect(pbo, false);
+
+    rlEnableFramebuffer(copy.id);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[pbo]);
+    glReadPixels(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    rlDisableFramebuffer();
+    fences[pbo] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ++captured;
+}
+
+void FrameCapture::drawIndicator()
+{
+    if (!capturing)
+        return;
+    const int seconds = static_cast<int>(elapsed);
+    const char *text =
+        dropped > 0 ? TextFormat("REC %02d:%02d  %u kare atlandi", seconds / 60, seconds % 60,
+                                 dropped)
+                    : TextFormat("REC %02d:%02d", seconds / 60, seconds % 60);
+    const int x = (GetScreenWidth() - MeasureText(text, 18)) / 2;
+    DrawCircle(x - 12, 17, 6.f, RED);
+    DrawText(text, x, 8, 18, RED);
+}
+
+void FrameCapture::collect(size_t pbo, bool wait)
+{
+    if (!fences[pbo])
+        return;
+    const auto fence = static_cast<GLsync>(std::exchange(fences[pbo], nullptr));
+    // mapping a buffer the GPU is still filling would stall, only stop() waits for one
+    const GLenum status = wait ? glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000)
+                               : glClientWaitSync(fence, 0, 0);
+    glDeleteSync(fence);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+        ++dropped;
+        return;
+    }
+
+    size_t frame;
+    {
+        std::lock_guard lock(mutex);
+        if (freeCount == 0) {
+            ++dropped; // the worker is behind, the frame isn't even mapped
+            return;
+        }
+        frame = freeFrames[--freeCount];
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[pbo]);
+    const void *pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, FRAME_BYTES, GL_MAP_READ_BIT);
+    if (pixels) {
+        std::memcpy(frames[frame].data(), pixels, FRAME_BYTES);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    {
+        std::lock_guard lock(mutex);
+        if (!pixels) {
+            freeFrames[freeCount++] = frame;
+            ++dropped;
+            return;
+        }
+        readyFrames[(readyFirst + readyCount++) % QUEUE_FRAMES] = frame;
+    }
+    wake.notify_one();
+}
+
+void FrameCapture::work()
+{
+    Profiler::setThreadName("capture");
+    std::vector<uint8_t> yuv; // reused for every frame
+    for (;;) {
+        size_t frame;
+        {
+            std::unique_lock lock(mutex);
+            wake.wait(lock, [] { return readyCount > 0 || stopping; });
+            if (readyCount == 0)
+                break;
+            frame = readyFrames[readyFirst];
+            readyFirst = (readyFirst + 1) % QUEUE_FRAMES;
+            --readyCount;
+        }
+
+        // after a failed write the frames are only handed back until stop()
+        if (!failed.load(std::memory_order_relaxed)) {
+            PROFILE_ZONE("writeFrame");
+            if (writeFrame(frames[frame], yuv))
+                written.fetch_add(1, std::memory_order_relaxed);
+            else
+                failed.store(true, std::memory_order_relaxed);
+        }
+
+        std::lock_guard lock(mutex);
+        freeFrames[freeCount++] = frame;
+    }
+
+    for (auto &frame : frames) {
+        frame.clear();
+        frame.shrink_to_fit();
+    }
+    // an encoder finishes the video before pclose returns, that can take seconds. the
+    // main thread only touches closing after joining this one
+    closing.push_back(std::async(std::launch::async, closeOutput, std::exchange(output, nullptr),
+                                 isPipe, written.load(std::memory_order_relaxed), dropped,
+                                 captured));
+}
+
+void FrameCapture::closeOutput(FILE *file, bool pipe, uint32_t frames, uint32_t lost,
+                               uint32_t total)
+{
+    if (pipe)
+        pclose(file);
+    else
+        std::fclose(file);
+    TraceLog(LOG_INFO, "Capture: %u frames written", frames);
+    if (lost > 0)
+        TraceLog(LOG_WARNING, "Capture: %u of %u frames dropped, the encoder fell behind", lost,
+                 total);
+}
+
+bool FrameCapture::writeFrame(const std::vector<uint8_t> &rgba, std::vector<uint8_t> &yuv)
+{
+    if (format == Format::RAW)
+        return std::fwrite(rgba.data(), 1, rgba.size(), output) == rgba.size();
+
+    // BT.601 full range as C420jpeg says, the chroma of every 2x2 block is averaged
+    constexpr int width = SCREEN_WIDTH;
+    constexpr int height = SCREEN_HEIGHT;
+    yuv.resize(size_t{width} * height * 3 / 2);
+    uint8_t *lumaPlane = yuv.data();
+    uint8_t *uPlane = lumaPlane + width * height;
+    uint8_t *vPlane = uPlane + width * height / 4;
+
+    for (int i = 0; i < width * height; ++i) {
+        const uint8_t *pixel = &rgba[i * 4];
+        lumaPlane[i] = static_cast<uint8_t>((77 * pixel[0] + 150 * pixel[1] + 29 * pixel[2]) >> 8);
+    }
+    for (int y = 0; y < height / 2; ++y) {
+        for (int x = 0; x < width / 2; ++x) {
+            int r = 0, g = 0, b = 0;
+            for (const int offset : {0, 1, width, width + 1}) {
+                const uint8_t *pixel = &rgba[((y * 2) * width + x * 2 + offset) * 4];
+                r += pixel[0];
+                g += pixel[1];
+                b += pixel[2];
+            }
+            // the sums are 4 pixels, the shifts divide by 256 * 4
+            const int u = ((-43 * r - 85 * g + 128 * b) >> 10) + 128;
+            const int v = ((128 * r - 107 * g - 21 * b) >> 10) + 128;
+            uPlane[y * (width / 2) + x] = static_cast<uint8_t>(std::clamp(u, 0, 255));
+            vPlane[y * (width / 2) + x] = static_cast<uint8_t>(std::clamp(v, 0, 255));
+        }
+    }
+
+    return std::fputs("FRAME\n", output) >= 0 &&
+           std::fwrite(yuv.data(), 1, yuv.size(), output) == yuv.size();
+}
@@ -1,51 +1,227 @@
 #include "Game.hpp"
 
+#include "AllocTracker.hpp"
+#include "AssetReloader.hpp"
+#include "AttackPatterns.hpp"
+#include "Benchmark.hpp"
 #include "Constants.hpp"
 #include "Difficulty.hpp"
+#include "FrameArena.hpp"
+#include "FrameCapture.hpp"
+#include "Ghost.hpp"
 #include "GlobalBounds.hpp"
+#include "HitchDetector.hpp"
+#include "HitPredictor.hpp"
 #include "Input.hpp"
 #include "MainMenu.hpp"
+#include "MusicCache.hpp"
+#include "Netplay.hpp"
 #include "PauseScreen.hpp"
+#include "Profiler.hpp"
+#include "QualityGovernor.hpp"
+#include "Random.hpp"
+#include "RenderTarget.hpp"
+#include "Replay.hpp"
+#include "RunStore.hpp"
+#include "SamplingProfiler.hpp"
 #include "Settings.hpp"
+#include "Sfx.hpp"
+#include "Survival.hpp"
+#include "Telemetry.hpp"
+#include "TimerWheel.hpp"
 #include "raylib.h"
 #include "raymath.h"
 
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <cmath>
 #include <cstring>
+#include <filesystem>
+#include <future>
 #include <memory>
+#include <random>
+#include <string>
+#include <utility>
+
+namespace {
+// logs how long a startup phase took, phases on worker threads overlap the main thread
+class StartupPhase
+{
+public:
+    explicit StartupPhase(const char *phaseName)
+        : name(phaseName), start(std::chrono::steady_clock::now())
+    {
+    }
+    ~StartupPhase()
+    {
+        const std::chrono::duration<float, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        TraceLog(LOG_INFO, "Startup: %s took %.1f ms", name, elapsed.count());
+    }
+
+    StartupPhase(const StartupPhase &) = delete;
+    StartupPhase &operator=(const StartupPhase &) = delete;
+
+private:
+    const char *name;
+    std::chrono::steady_clock::time_point start;
+};
+
+#define STARTUP_PHASE(name)                                                                        \
+    PROFILE_ZONE(name);                                                                            \
+    const StartupPhase startupPhase(name)
+
+// finished entities are parked in a free list instead of being destroyed, spawning them
+// again reuses both the object and the capacity of its containers. returns how many
+template <typename T>
+size_t recycleDead(std::vector<std::unique_ptr<T>> &entities,
+                 std::vector<std::unique_ptr<T>> &freeList)
+{
+    size_t alive = 0;
+    for (auto &entity : entities) {
+        if (!entity->isAlive())
+            freeList.push_back(std::move(entity));
+        else if (&entity != &entities[alive++])
+            entities[alive - 1] = std::move(entity);
+    }
+    const size_t recycled = entities.size() - alive;
+    entities.erase(entities.begin() + static_cast<std::ptrdiff_t>(alive), entities.end());
+    return recycled;
+}
+
+template <typename T>
+void recycleAll(std::vector<std::unique_ptr<T>> &entities,
+                std::vector<std::unique_ptr<T>> &freeList)
+{
+    HitchDetector::recordRecycled(entities.size());
+    for (auto &entity : entities)
+        freeList.push_back(std::move(entity));
+    entities.clear();
+}
+} // namespace
 
 Game::Game()
     : player(nullptr), shouldClose(false), shouldRestart(false), gameState(GameState::MAIN_MENU),
-      bombTimer(0.f), attackTimer(0.f), timeEnd(0.f), boss(nullptr), isShaking(false)
+      timeEnd(0.f), boss(nullptr), isShaking(false)
 {
 }
 
 float Game::gameTime = 0.f;
+float Game::deltaTime = 0.f;
 
 void Game::init()
 {
-    Settings::load();
-    if (!Settings::tempConfig.vsync)
-        ClearWindowState(FLAG_VSYNC_HINT);
-	// Set configuration flags for window creation
-    SetConfigFlags((Settings::tempConfig.vsync ? FLAG_VSYNC_HINT : 0) | FLAG_WINDOW_HIGHDPI);
-    InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Kurdistan Bombalayici");
-    SetExitKey(KEY_NULL); // disable ESC key
-    if (!shouldRestart)
-        InitAudioDevice();
-    InitMovementBounds(GetScreenWidth(), GetScreenHeight());
-    SetWindowIcon(LoadImage("assets/icon.png"));
+    initStart = std::chrono::steady_clock::now();
+    firstFrameShown = false;
+    STARTUP_PHASE("init");
+
+    {
+        // the window flags depend on the settings, everything else can overlap
+        STARTUP_PHASE("loadSettings");
+        Settings::load();
+    }
+    if (Benchmark::isRunning()) {
+        // run as fast as possible, only for this session, nothing is saved
+        Settings::tempConfig.vsync = false;
+        Settings::tempConfig.targetFPS = 0;
+    }
+
+    constexpr const char *musicFiles[] = {"assets/bg_music.mp3", "assets/bg_music_funk.mp3"};
+    constexpr const char *imageFiles[] = {"assets/icon.png", "assets/boss.png",
+                                          "assets/player.png", "assets/bomb.png",
+                                          "assets/larei.png"};
+
+    // the audio device outlives window restarts, so the music streams do too
+    const bool loadAudio = bgMusics.empty();
+    auto audioTask = std::async(std::launch::async, [&musicFiles, loadAudio]() {
+        std::vector<Music> musics;
+        if (!loadAudio)
+            return musics;
+        Profiler::setThreadName("init audio");
+        {
+            STARTUP_PHASE("initAudioDevice");
+            if (!IsAudioDeviceReady())
+                InitAudioDevice();
+        }
+        STARTUP_PHASE("loadMusic");
+        for (const char *file : musicFiles)
+            musics.push_back(MusicCache::load(file));
+        Sfx::init();
+        return musics;
+    });
+
+    // decoding is plain CPU work, only the upload needs the GL context
+    std::array<std::future<Image>, std::size(imageFiles)> imageTasks;
+    for (size_t i = 0; i < std::size(imageFiles); ++i) {
+        imageTasks[i] = std::async(std::launch::async, [file = imageFiles[i]]() {
+            Profiler::setThreadName("init images");
+            STARTUP_PHASE(file);
+            return LoadImage(file);
+        });
+    }
+
+    auto patternTask = std::async(std::launch::async, []() {
+        Profiler::setThreadName("init patterns");
+        STARTUP_PHASE("loadPatterns");
+        AttackPatterns::load(ATTACK_PATTERNS_PATH);
+    });
+
+    // the run history only changes while the game runs, it survives window restarts
+    std::future<void> runsTask;
+    if (!shouldRestart) {
+        runsTask = std::async(std::launch::async, []() {
+            Profiler::setThreadName("init runs");
+            STARTUP_PHASE("loadRuns");
+            RunStore::load();
+        });
+    }
 
-    bossTexture = LoadTexture("assets/boss.png");
-    playerTexture = LoadTexture("assets/player.png");
-    bombTexture = LoadTexture("assets/bomb.png");
-    lareiTexture = LoadTexture("assets/larei.png");
+    // connecting waits on the discord client, it must not hold up the first frame. it's
+    // only polled after the frames, see pollDiscord()
+    if (!shouldRestart && Settings::tempConfig.discordRPC) {
+        discordTask = std::async(std::launch::async, [this]() {
+            Profiler::setThreadName("init discord");
+            STARTUP_PHASE("connectDiscord");
+            openDiscord();
+        });
+    }
 
-    std::vector<std::string> musicFiles = {"assets/bg_music.mp3", "assets/bg_music_funk.mp3"};
+    {
+        STARTUP_PHASE("initWindow");
+        if (!Settings::tempConfig.vsync)
+            ClearWindowState(FLAG_VSYNC_HINT);
+        // Set configuration flags for window creation
+        SetConfigFlags((Settings::tempConfig.vsync ? FLAG_VSYNC_HINT : 0) | FLAG_WINDOW_HIGHDPI |
+                       (Benchmark::isRunning() ? FLAG_WINDOW_HIDDEN : 0));
+        InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Kurdistan Bombalayici");
+        SetExitKey(KEY_NULL); // disable ESC key
+        // gameplay runs in fixed coordinates, the window only changes how the frame is scaled
+        InitMovementBounds(SCREEN_WIDTH, SCREEN_HEIGHT);
+        RenderTarget::init(QualityGovernor::renderScale(Settings::tempConfig.renderScale));
+    }
+
+    {
+        STARTUP_PHASE("uploadTextures");
+        const Image icon = imageTasks[0].get();
+        SetWindowIcon(icon);
+        UnloadImage(icon);
+
+        Texture2D *textures[] = {&bossTexture, &playerTexture, &bombTexture, &lareiTexture};
+        for (size_t i = 0; i < std::size(textures); ++i) {
+            const Image image = imageTasks[i + 1].get();
+            *textures[i] = LoadTextureFromImage(image);
+            UnloadImage(image);
+        }
+    }
 
-    for (auto &file : musicFiles) {
-        bgMusics.push_back(LoadMusicStream(file.c_str()));
+    {
+        STARTUP_PHASE("joinWorkers");
+        patternTask.get();
+        if (runsTask.valid())
+            runsTask.get();
+        if (loadAudio)
+            bgMusics = audioTask.get();
     }
 
     bgMusic = &bgMusics[Settings::tempConfig.bgMusicIndex];
@@ -62,41 +238,201 @@ void Game::init()
     if (!shouldRestart) {
         player = std::make_unique<Player>(playerTexture);
         boss = std::make_unique<Boss>(bossTexture, lareiTexture);
+
+#ifdef HOT_RELOAD
+        AssetReloader::watchTexture("assets/boss.png", &bossTexture);
+        AssetReloader::watchTexture("assets/player.png", &playerTexture);
+        AssetReloader::watchTexture("assets/bomb.png", &bombTexture);
+        AssetReloader::watchTexture("assets/larei.png", &lareiTexture);
+        for (size_t i = 0; i < std::size(musicFiles); ++i)
+            AssetReloader::watchMusic(musicFiles[i], &bgMusics[i]);
+        AssetReloader::start("assets");
+#endif
+
+        // --replay skips the menu, --host and --join wait for the session
+        if (ReplayPlayback::isActive() && gameState != GameState::GAME_ERROR_TEXTURE)
+            startReplay();
+        else if (Netplay::state() == NetState::CONNECTING &&
+                 gameState != GameState::GAME_ERROR_TEXTURE)
+            setGameState(GameState::CONNECTING);
     } else {
         TraceLog(LOG_INFO, "Game restarted");
         shouldRestart = false;
     }
+
+    // loading is slow anyway, the median starts over with the first real frames
+    HitchDetector::reset();
 }
 
 void Game::reset()
 {
     gameState = GameState::MAIN_MENU;
-    bombTimer = 0.f;
-    attackTimer = 0.f;
     timeEnd = 0.f;
     gameTime = 0.f;
-    bossAttacks.clear();
-    bombs.clear();
+    recycleAll(bossAttacks, freeAttacks);
+    recycleAll(bombs, freeBombs);
+    if (isShaking)
+        SetWindowPosition(windowPos.x, windowPos.y); // its timer is cleared below
     isShaking = false;
 
+    // the predicted hits only know one player
+    HitPredictor::enabled = Settings::config.hitPrediction && !partner;
+    HitPredictor::reset();
+    Telemetry::reset();
+    Survival::reset();
+
     if (player)
         player->init();
+    if (partner)
+        partner->init();
     if (boss)
         boss->init();
 
+    // a new run gets new numbers, benchmark runs always play the same ones and both sides
+    // of a co-op game the host's. InitWindow seeds raylib from the clock, so the benchmark
+    // seeds it here too, every reset runs after the window is up
+    if (partner) {
+        Random::seed(Netplay::seed());
+    } else if (Benchmark::isRunning()) {
+        Random::seed(BENCHMARK_SEED);
+        SetRandomSeed(BENCHMARK_SEED);
+    } else {
+        std::random_device device;
+        Random::seed(uint64_t{device()} << 32 | device());
+    }
+
+    // the scripts wait on the wheel, both start over together
+    TimerWheel::clear();
+    spawnScripts({}, {});
+    inputInterrupted = true;
+
+    if (isRecordedRun()) {
+        ReplayRecorder::begin(currentDifficulty, Survival::enabled, HitPredictor::enabled);
+        keyframe.clear();
+        saveState(keyframe);
+        ReplayRecorder::addKeyframe(gameTime, keyframe);
+        Ghost::start(RunStore::board(currentDifficulty,
+                                     Survival::enabled ? RunMode::SURVIVAL : RunMode::NORMAL),
+                     playerTexture);
+    } else {
+        Ghost::stop();
+    }
+
     StopMusicStream(*bgMusic);
 }
 
+void Game::saveState(std::vector<uint8_t> &bytes) const
+{
+    // read back in the same order by loadState()
+    StateWriter writer(bytes);
+    writer.write(gameTime);
+    writer.write(TimerWheel::tick());
+    writer.write(TimerWheel::sequence());
+    writer.write(Random::getState());
+    player->save(writer);
+    if (partner)
+        partner->save(writer);
+    boss->save(writer);
+    HitPredictor::save(writer);
+    writer.write(ScriptScheduler::pendingDelay(attackScriptHandle));
+    writer.write(ScriptScheduler::pendingDelay(bombScriptHandle));
+    // in update order, it decides which attack hits first
+    writer.write(static_cast<uint32_t>(bossAttacks.size()));
+    for (const auto &attack : bossAttacks)
+        attack->save(writer);
+    writer.write(static_cast<uint32_t>(bombs.size()));
+    for (const auto &bomb : bombs)
+        bomb->save(writer);
+}
+
+bool Game::loadState(std::span<const uint8_t> bytes)
+{
+    if (isShaking)
+        SetWindowPosition(windowPos.x, windowPos.y); // its timer is cleared below
+    isShaking = false;
+    recycleAll(bossAttacks, freeAttacks);
+    recycleAll(bombs, freeBombs);
+
+    StateReader reader(bytes);
+    gameTime = reader.read<float>();
+    const auto tick = reader.read<uint32_t>();
+    const auto sequence = reader.read<uint32_t>();
+    // the timers of the state go on the wheel as they are loaded
+    TimerWheel::restore(tick, sequence);
+    Random::setState(reader.read<Random::State>());
+    player->load(reader);
+    if (partner)
+        partner->load(reader);
+    boss->load(reader);
+    HitPredictor::load(reader);
+    const auto attackDue = reader.read<TimerDue>();
+    const auto bombDue = reader.read<TimerDue>();
+
+    {
+        ALLOC_SCOPE(ATTACKS);
+        for (auto count = reader.read<uint32_t>(); count > 0 && !reader.hasFailed(); --count) {
+            if (freeAttacks.empty()) {
+                bossAttacks.emplace_back(std::make_unique<BossAttack>(reader));
+            } else {
+                bossAttacks.emplace_back(std::move(freeAttacks.back()));
+                freeAttacks.pop_back();
+                bossAttacks.back()->load(reader);
+            }
+        }
+    }
+    {
+        ALLOC_SCOPE(BOMBS);
+        for (auto count = reader.read<uint32_t>(); count > 0 && !reader.hasFailed(); --count) {
+            if (freeBombs.empty()) {
+                bombs.emplace_back(std::make_unique<Bomb>(bombTexture, reader));
+            } else {
+                bombs.emplace_back(std::move(freeBombs.back()));
+                freeBombs.pop_back();
+                bombs.back()->load(reader);
+            }
+        }
+    }
+
+    spawnScripts(attackDue, bombDue);
+    return !reader.hasFailed();
+}
+
+void Game::spawnScripts(TimerDue attackDue, TimerDue bombDue)
+{
+    ScriptScheduler::clear();
+    attackScriptHandle = ScriptScheduler::spawn(attackScript(attackDue));
+    bombScriptHandle = ScriptScheduler::spawn(bombScript(bombDue));
+    ScriptScheduler::spawn(bossPhaseScript());
+    // started right away, a keyframe between two ticks always finds their delays on the wheel
+    ScriptScheduler::update();
+}
+
 void Game::update()
 {
+    PROFILE_ZONE("update");
     if (shouldRestart) {
         // restart the window
         TraceLog(LOG_INFO, "Restarting game");
+        // its buffers go with the GL context, the recording goes on in a new file
+        const bool wasCapturing = FrameCapture::isCapturing();
+        FrameCapture::stop();
+        RenderTarget::unload();
         CloseWindow();
         init();
+        if (wasCapturing)
+            FrameCapture::start(FrameCapture::defaultPath(), FrameCapture::fps());
         return;
     }
 
+    // a fixed step makes benchmark runs the same workload on every machine. otherwise the
+    // frame time is turned into replay steps, so a replay simulates exactly the same ticks
+    if (Benchmark::isRunning()) {
+        deltaTime = Benchmark::FRAME_TIME;
+    } else {
+        tickSteps = stepClock.next(GetFrameTime());
+        deltaTime = replayStepSeconds(tickSteps);
+    }
+
     fpsTimer += GetFrameTime();
     framesThisSecond++;
 
@@ -114,45 +450,65 @@ void Game::update()
         StopMusicStream(*bgMusic);
     }
 
-    UpdateMusicStream(*bgMusic);
+    {
+        ALLOC_SCOPE(AUDIO);
+        PROFILE_ZONE("UpdateMusicStream");
+        UpdateMusicStream(*bgMusic);
+    }
+
+    // every frame, the end screens still send the peer what it may be missing
+    if (Netplay::state() != NetState::OFF) {
+        PROFILE_ZONE("netplay");
+        Netplay::poll();
+    }
 
     switch (gameState) {
+        case GameState::CONNECTING:
+            if (Netplay::state() == NetState::RUNNING) {
+                startNetGame();
+            } else if (Netplay::state() != NetState::CONNECTING) {
+                TraceLog(LOG_WARNING, "Netplay: could not connect");
+                endNetGame();
+            }
+            break;
         case GameState::PLAYING:
             Input::unlockMouse();
 
-            updateTimers();
-            if (player)
-                player->update();
-            if (boss)
-                boss->update(GetFrameTime());
-
-            // we are not using elements.erase(elements.begin() + i) because it has O(n²) complexity
-            // instead we are using std::erase_if to remove all inactive elements
-
-            // update boss attacks
-            for (size_t i = 0; i < bossAttacks.size(); ++i) {
-                BossAttack &attack = *bossAttacks[i];
-                attack.update(*player);
-                if (!attack.isAlive()) {
-                    std::erase_if(bossAttacks, [](auto &attk) { return !attk->isAlive(); });
-                    --i;
+            if (ReplayPlayback::isActive()) {
+                playReplay();
+            } else if (partner) {
+                playNet();
+            } else {
+                PlayerInput input = Player::readInput();
+                if (std::exchange(inputInterrupted, false))
+                    input.buttons |= PlayerInput::RESET_TARGET;
+                tick(input);
+
+                if (ReplayRecorder::isRecording()) {
+                    ReplayRecorder::addTick(tickSteps, input, gameTime);
+                    if (gameState == GameState::PLAYING &&
+                        ReplayRecorder::wantsKeyframe(gameTime, bulletCount)) {
+                        keyframe.clear();
+                        saveState(keyframe);
+                        ReplayRecorder::addKeyframe(gameTime, keyframe);
+                    }
                 }
-            }
-
-            // update bombs
-            for (size_t i = 0; i < bombs.size(); ++i) {
-                Bomb &bomb = *bombs[i];
-                bomb.update(*player, *boss, GetFrameTime());
-                if (!bomb.isAlive()) {
-                    std::erase_if(bombs, [](auto &bmb) { return !bmb->isAlive(); });
-                    --i;
+                {
+                    PROFILE_ZONE("ghost");
+                    Ghost::update(gameTime);
                 }
             }
 
-            if (player->health <= 0.f)
-                setGameState(GameState::GAME_OVER);
-            if (boss->health <= 0.f)
-                setGameState(GameState::WIN);
+            {
+                Telemetry::recordFrame(GetFrameTime(), gameTime, bulletCount, bossAttacks.size(),
+                                       bombs.size());
+                if (Survival::enabled)
+                    Survival::recordFrame(GetFrameTime(),
+                                          bulletCount + bossAttacks.size() + bombs.size());
+            }
+            // benchmark runs measure one fixed workload
+            if (!Benchmark::isRunning())
+                QualityGovernor::update(GetFrameTime());
 
             // shake the window
             if (isShaking) {
@@ -166,25 +522,25 @@ void Game::update()
                         shakeIntensity * progress; // intensity decreases over time
 
                     // we are using a random angle to shake the window
-                    // shake the window in a circle
+                    // shake the window in a circle. cosmetic, so not from the simulation's
+                    // Random and replays don't depend on the shake setting
                     const float angle = GetRandomValue(0, 360) * DEG2RAD;
                     const float offsetX = cosf(angle) * currentIntensity;
                     const float offsetY = sinf(angle) * currentIntensity;
 
-                    SetWindowPosition(windowPos.x + offsetX, windowPos.y + offsetY);
-                } else {
-                    // reset window position
-                    SetWindowPosition(windowPos.x, windowPos.y);
-                    isShaking = false;
+                    if (QualityGovernor::shake())
+                        SetWindowPosition(windowPos.x + offsetX, windowPos.y + offsetY);
                 }
+                // the shake timer puts the window back
             }
             break;
         default:
             break;
     }
 
+    // the mouse target is reset on the next tick, so replays see it too
     if (gameState != GameState::PLAYING)
-        player->resetMouseTarget(); // reset mouse target when not playing
+        inputInterrupted = true;
 
     if (gameState != lastGameState) {
         switch (gameState) {
@@ -199,11 +555,34 @@ void Game::update()
                 break;
             case GameState::WIN:
                 TraceLog(LOG_INFO, "Game won");
+                if (isRecordedRun()) {
+                    Telemetry::endRun(RunResult::WIN, RunMode::NORMAL, gameTime);
+                    RunStore::add(gameTime, currentDifficulty, RunMode::NORMAL, RunResult::WIN, 0,
+                                  0);
+                    saveReplay(RunResult::WIN, RunMode::NORMAL);
+                }
                 setDiscordActivity(getDifficultyName(currentDifficulty), "Ankara kurtarildi!",
                                    GetTime() / 1000);
                 break;
             case GameState::GAME_OVER:
                 TraceLog(LOG_INFO, "Game over");
+                if (Survival::enabled)
+                    TraceLog(LOG_INFO, "Survival: level %d, peak %zu entities at 60 fps",
+                             Survival::level() + 1, Survival::peakEntities());
+                if (isRecordedRun()) {
+                    Telemetry::endRun(RunResult::GAME_OVER,
+                                      Survival::enabled ? RunMode::SURVIVAL : RunMode::NORMAL,
+                                      gameTime);
+                    if (Survival::enabled)
+                        RunStore::add(gameTime, currentDifficulty, RunMode::SURVIVAL,
+                                      RunResult::GAME_OVER, Survival::level() + 1,
+                                      static_cast<uint32_t>(Survival::peakEntities()));
+                    else
+                        RunStore::add(gameTime, currentDifficulty, RunMode::NORMAL,
+                                      RunResult::GAME_OVER, 0, 0);
+                    saveReplay(RunResult::GAME_OVER,
+                               Survival::enabled ? RunMode::SURVIVAL : RunMode::NORMAL);
+                }
                 setDiscordActivity(getDifficultyName(currentDifficulty), "Ankara dustu!",
                                    GetTime() / 1000);
                 break;
@@ -217,7 +596,8 @@ void Game::update()
 
 void Game::draw() const
 {
-    BeginDrawing();
+    PROFILE_ZONE("draw");
+    RenderTarget::begin();
     ClearBackground(Color{10, 10, 10, 255});
 
     switch (gameState) {
@@ -228,15 +608,36 @@ void Game::draw() const
                 attack->draw();
 
             boss->draw();
+            Ghost::draw();
             player->draw();
+            if (partner)
+                partner->draw();
 
             // we are using DrawText instead of drawTextCenter to avoid text scaling issues
 
             // draw menu items
-            DrawText(TextFormat("Zaman: %s", formatTime()), GetScreenWidth() - TEXT_HEIGHT * 6.5f,
+            DrawText(TextFormat("Zaman: %s", formatTime()), SCREEN_WIDTH - TEXT_HEIGHT * 6.5f,
                      TEXT_HEIGHT * 0.5, 20, WHITE);
-            DrawText(TextFormat("FPS: %d", currentFPS), GetScreenWidth() - TEXT_HEIGHT * 3,
-                     GetScreenHeight() - TEXT_HEIGHT, 18, WHITE);
+            DrawText(TextFormat("FPS: %d", currentFPS), SCREEN_WIDTH - TEXT_HEIGHT * 3,
+                     SCREEN_HEIGHT - TEXT_HEIGHT, 18, WHITE);
+            if (Survival::enabled) {
+                DrawText(TextFormat("Seviye: %d", Survival::level() + 1),
+                         SCREEN_WIDTH - TEXT_HEIGHT * 6.5f, TEXT_HEIGHT * 1.5f, 18, ORANGE);
+                DrawText(TextFormat("Nesne: %zu", Survival::liveEntities()), TEXT_HEIGHT * 0.5f,
+                         SCREEN_HEIGHT - TEXT_HEIGHT * 2, 18, WHITE);
+                DrawText(TextFormat("60 FPS zirve: %zu", Survival::peakEntities()),
+                         TEXT_HEIGHT * 0.5f, SCREEN_HEIGHT - TEXT_HEIGHT, 18, ORANGE);
+            }
+            if (ReplayPlayback::isActive()) {
+                DrawText(TextFormat("Tekrar %s / %s", formatTime(),
+                                    formatTime(ReplayPlayback::header().duration)),
+                         TEXT_HEIGHT * 0.5f, TEXT_HEIGHT * 0.5f, 20, SKYBLUE);
+                DrawText("Sag: hizli  Sol: 10 sn geri  Yukari: 30 sn ileri", TEXT_HEIGHT * 0.5f,
+                         TEXT_HEIGHT * 1.5f, 18, LIGHTGRAY);
+            }
+#ifdef ALLOC_TRACKING
+            AllocTracker::drawOverlay();
+#endif
             break;
         case GameState::GAME_OVER:
             drawTextCenter("Beceriksizsin", SCREEN_DRAW_X, SCREEN_DRAW_Y + TEXT_HEIGHT * -2, 20,
@@ -249,6 +650,14 @@ void Game::draw() const
                            SCREEN_DRAW_Y + TEXT_HEIGHT * 4, 20, WHITE);
             drawTextCenter("Kurt isen ESC atabilirsin", SCREEN_DRAW_X,
                            SCREEN_DRAW_Y + TEXT_HEIGHT * 5, 20, WHITE);
+            if (Survival::enabled) {
+                drawTextCenter(TextFormat("Dayanilan Sure: %s, Seviye: %d", formatTime(),
+                                          Survival::level() + 1),
+                               SCREEN_DRAW_X, SCREEN_DRAW_Y + TEXT_HEIGHT * 7, 20, ORANGE);
+                drawTextCenter(TextFormat("60 FPS'te en fazla %zu nesne", Survival::peakEntities()),
+                               SCREEN_DRAW_X, SCREEN_DRAW_Y + TEXT_HEIGHT * 8, 20, ORANGE);
+                drawBestTime(RunMode::SURVIVAL, SCREEN_DRAW_Y + TEXT_HEIGHT * 9);
+            }
             break;
         case GameState::WIN:
             drawTextCenter("Helal Olsun!", SCREEN_DRAW_X, SCREEN_DRAW_Y + TEXT_HEIGHT * -2, 20,
@@ -271,6 +680,7 @@ void Game::draw() const
                                currentDifficulty == Difficulty::EASY     ? GREEN
                                : currentDifficulty == Difficulty::NORMAL ? YELLOW
                                                                          : DARKRED}});
+            drawBestTime(RunMode::NORMAL, SCREEN_DRAW_Y + TEXT_HEIGHT * 9);
             break;
         case GameState::MAIN_MENU:
             MainMenu::draw();
@@ -278,6 +688,15 @@ void Game::draw() const
         case GameState::PAUSED:
             PauseScreen::draw();
             break;
+        case GameState::CONNECTING:
+            if (Netplay::isHost())
+                drawTextCenter(TextFormat("Ikinci oyuncu bekleniyor (port %u)", Netplay::port()),
+                               SCREEN_DRAW_X, SCREEN_DRAW_Y, 20, WHITE);
+            else
+                drawTextCenter("Sunucuya baglaniliyor", SCREEN_DRAW_X, SCREEN_DRAW_Y, 20, WHITE);
+            drawTextCenter("Vazgecmek icin ESC'ye bas", SCREEN_DRAW_X,
+                           SCREEN_DRAW_Y + TEXT_HEIGHT * 2, 20, LIGHTGRAY);
+            break;
         case GameState::GAME_ERROR_TEXTURE:
             drawTextCenter("Bir hata olustu", SCREEN_DRAW_X, SCREEN_DRAW_Y + TEXT_HEIGHT * -2, 20,
                            RED);
@@ -292,14 +711,37 @@ void Game::draw() const
             break;
     }
 
-    EndDrawing();
+    {
+        // includes the scaled blit, the buffer swap and waiting for vsync
+        PROFILE_ZONE("present");
+        RenderTarget::present();
+    }
 }
 
 void Game::handleInput()
 {
+    PROFILE_ZONE("handleInput");
+
+    if (Input::isTraceKey()) {
+        if (Profiler::isCapturing())
+            Profiler::stop();
+        else
+            Profiler::start(Settings::getConfigPath(TRACE_FILE_NAME), TRACE_DEFAULT_SECONDS);
+    }
+    if (Input::isCaptureKey()) {
+        if (FrameCapture::isCapturing())
+            FrameCapture::stop();
+        else
+            FrameCapture::start(FrameCapture::defaultPath(), CAPTURE_DEFAULT_FPS);
+    }
+
     switch (gameState) {
         case GameState::PLAYING:
-            if (Input::isEscapeKey()) {
+            // the peer can't wait, leaving is the only way out of co-op
+            if (Input::isEscapeKey() && partner) {
+                TraceLog(LOG_INFO, "Netplay: left the game");
+                endNetGame();
+            } else if (Input::isEscapeKey()) {
                 TraceLog(LOG_INFO, "Game paused");
                 setGameState(GameState::PAUSED);
             }
@@ -318,11 +760,20 @@ void Game::handleInput()
         case GameState::PAUSED:
             PauseScreen::handleInput();
             break;
+        case GameState::CONNECTING:
+            if (Input::isEscapeKey())
+                endNetGame();
+            break;
         case GameState::WIN:
         case GameState::GAME_OVER:
-            if (Input::isResetKey()) {
-                reset();
-                setGameState(GameState::PLAYING);
+            // a co-op game is played once, both sides would have to agree on another
+            if (Input::isResetKey() && !partner) {
+                if (ReplayPlayback::isActive()) {
+                    startReplay(); // watch it again
+                } else {
+                    reset();
+                    setGameState(GameState::PLAYING);
+                }
             }
             if (Input::isEscapeKey()) {
                 cleanup();
@@ -341,9 +792,49 @@ void Game::handleInput()
 
 void Game::updateFrame()
 {
-    handleInput();
-    update();
-    draw();
+#ifdef HOT_RELOAD
+    // swapped in before anything of this frame touches the textures
+    AssetReloader::apply();
+#endif
+    if (Benchmark::isRunning())
+        Benchmark::beginFrame(*this);
+
+    {
+        PROFILE_ZONE("frame");
+        handleInput();
+        update();
+        draw();
+    }
+    Profiler::endFrame();
+
+    // everything this frame asked for is mixed in at most once per effect
+    Sfx::flush();
+
+#ifdef SAMPLING_PROFILER
+    SamplingProfiler::setActive(gameState == GameState::PLAYING);
+    SamplingProfiler::collect();
+#endif
+
+#ifdef ALLOC_TRACKING
+    // only gameplay frames count against the budget, menus and loading are free to allocate
+    AllocTracker::endFrame(gameState == GameState::PLAYING);
+#endif
+
+    // everything allocated for this frame is released at once
+    FrameArena::reset();
+
+    if (Benchmark::isRunning())
+        Benchmark::endFrame(*this);
+
+    HitchDetector::endFrame();
+
+    if (!firstFrameShown) {
+        const std::chrono::duration<float, std::milli> elapsed =
+            std::chrono::steady_clock::now() - initStart;
+        TraceLog(LOG_INFO, "Startup: first frame after %.1f ms", elapsed.count());
+        firstFrameShown = true;
+    }
+    pollDiscord();
 }
 
 void Game::cleanup()
@@ -358,11 +849,22 @@ void Game::cleanup()
     UnloadTexture(playerTexture);
     UnloadTexture(bombTexture);
     UnloadTexture(lareiTexture);
+    FrameCapture::shutdown();
+    RenderTarget::unload();
     for (auto &music : bgMusics) {
         StopMusicStream(music);
         UnloadMusicStream(music);
     }
     bgMusics.clear();
+    MusicCache::release();
+    Ghost::stop();
+    Netplay::close();
+    HitchDetector::flush();
+    RunStore::shutdown();
+    Sfx::unload();
+#ifdef HOT_RELOAD
+    AssetReloader::stop(); // after the music streams, they may read its memory
+#endif
     if (IsAudioDeviceReady())
         CloseAudioDevice();
     disconnectDiscord();
@@ -376,6 +878,12 @@ void Game::setGameState(GameState newState)
         isShaking = false;
         SetWindowPosition(windowPos.x, windowPos.y);
     }
+    // the hitches of the run are written once it's no longer being played
+    if (newState != GameState::PLAYING)
+        HitchDetector::flush();
+    // leaving a replay for the menu goes back to playing yourself
+    if (newState == GameState::MAIN_MENU && ReplayPlayback::isActive())
+        ReplayPlayback::close();
 
     if (newState == GameState::GAME_OVER || newState == GameState::WIN ||
         newState == GameState::PAUSED) {
@@ -386,45 +894,371 @@ void Game::setGameState(GameState newState)
     gameState = newState;
 }
 
+template <Difficulty D> void Game::spawnAttackWave()
+{
+    constexpr auto difficulty = static_cast<size_t>(D);
+
+    if (Random::value(0, 1) == 0 &&
+        bossAttacks.size() <= BossAttackConfig::MAX_ALIVE_ATTACKS[difficulty]) { // 50%
+        const int attackCount =
+            Random::value(1, BossAttackConfig::MAX_ATTACKS_PER_SPAWN[difficulty]);
+        for (int j = 0; j < attackCount; ++j)
+            createAttack();
+    }
+}
+
 void Game::updateTimers()
 {
-    gameTime += GetFrameTime();
-    bombTimer += GetFrameTime();
-    attackTimer += GetFrameTime();
-
-    // spawn attacks
-    if (attackTimer >= 0.5f) {
-        if (GetRandomValue(0, 1) == 0 &&
-            (currentDifficulty != Difficulty::HARD ? bossAttacks.size() <= 3 : true)) { // 50%
-            const int max = (currentDifficulty == Difficulty::EASY)     ? 2
-                            : (currentDifficulty == Difficulty::NORMAL) ? 3
-                                                                        : 5;
-            const int attackCount = GetRandomValue(1, max);
-            for (int j = 0; j < attackCount; ++j)
+    gameTime += deltaTime;
+    // everything that expired this frame fires in one batch, then the woken scripts run
+    TimerWheel::advance(gameTime);
+    ScriptScheduler::update();
+}
+
+void Game::tick(const PlayerInput &input, const PlayerInput &partnerInput)
+{
+    if (const GameState end = step(input, partnerInput); end != GameState::PLAYING)
+        setGameState(end);
+}
+
+GameState Game::step(const PlayerInput &input, const PlayerInput &partnerInput)
+{
+    updateTimers();
+    if (player) {
+        PROFILE_ZONE("player");
+        // a downed co-op player stays where it fell
+        if (player->health > 0.f)
+            player->update(input, deltaTime);
+        if (partner && partner->health > 0.f)
+            partner->update(partnerInput, deltaTime);
+    }
+    if (HitPredictor::enabled)
+        HitPredictor::updatePath(*player, gameTime, deltaTime);
+    if (boss) {
+        PROFILE_ZONE("boss");
+        boss->update(deltaTime);
+    }
+
+    // we are not using elements.erase(elements.begin() + i) because it has O(n²) complexity
+    // instead dead elements are compacted out in one pass and kept for reuse
+
+    // update boss attacks
+    {
+        ALLOC_SCOPE(ATTACKS);
+        PROFILE_ZONE("attacks");
+        for (const auto &attack : bossAttacks)
+            attack->update(*player, partner.get());
+        HitchDetector::recordRecycled(recycleDead(bossAttacks, freeAttacks));
+    }
+
+    // update bombs
+    {
+        ALLOC_SCOPE(BOMBS);
+        PROFILE_ZONE("bombs");
+        for (const auto &bomb : bombs)
+            bomb->update(*player, partner.get(), *boss, deltaTime);
+        HitchDetector::recordRecycled(recycleDead(bombs, freeBombs));
+    }
+
+    bulletCount = 0;
+    for (const auto &attack : bossAttacks)
+        bulletCount += attack->bullets.size();
+    HitchDetector::recordEntities(bulletCount, bossAttacks.size(), bombs.size());
+
+    if (boss->health <= 0.f) {
+        if (Survival::enabled)
+            boss->init(); // can't be beaten, the bombs only buy some calm
+        else
+            return GameState::WIN;
+    }
+    if (player->health <= 0.f && (!partner || partner->health <= 0.f))
+        return GameState::GAME_OVER;
+    return GameState::PLAYING;
+}
+
+void Game::startReplay()
+{
+    const ReplayHeader &header = ReplayPlayback::header();
+    currentDifficulty = static_cast<Difficulty>(header.difficulty);
+    Survival::enabled = header.survival != 0;
+    reset();
+    HitPredictor::enabled = header.hitPrediction != 0;
+
+    if (!loadState(ReplayPlayback::seek(0))) {
+        TraceLog(LOG_WARNING, "Replay: the first keyframe is damaged");
+        setGameState(GameState::MAIN_MENU);
+        return;
+    }
+    replayClock = gameTime;
+    setGameState(GameState::PLAYING);
+}
+
+void Game::playReplay()
+{
+    if (Input::isArrowLeft()) {
+        seekReplay(gameTime - REPLAY_SEEK_BACK);
+        return;
+    }
+    if (Input::isArrowUp()) {
+        seekReplay(gameTime + REPLAY_SEEK_AHEAD);
+        return;
+    }
+
+    // the recorded ticks play at the speed they were recorded at, hold right to fast forward
+    replayClock += GetFrameTime() * (IsKeyDown(KEY_RIGHT) ? REPLAY_FAST_FORWARD : 1);
+    uint32_t steps;
+    PlayerInput input;
+    while (gameTime < replayClock && gameState == GameState::PLAYING) {
+        if (!ReplayPlayback::nextTick(steps, input)) {
+            TraceLog(LOG_INFO, "Replay finished");
+            setGameState(GameState::MAIN_MENU);
+            return;
+        }
+        deltaTime = replayStepSeconds(steps);
+        tick(input);
+    }
+}
+
+template <typename Ticks> bool Game::resimulate(Ticks ticks)
+{
+    Sfx::setMuted(true);
+    SetTraceLogLevel(LOG_WARNING);
+    HitchDetector::setSuspended(true);
+    const bool loaded = ticks();
+    HitchDetector::setSuspended(false);
+    SetTraceLogLevel(LOG_INFO);
+    Sfx::setMuted(false);
+    return loaded;
+}
+
+void Game::seekReplay(float target)
+{
+    PROFILE_ZONE("seek");
+    target = std::clamp(target, 0.f, ReplayPlayback::header().duration);
+    // back or past the next keyframe, the keyframe before the target is the shortest way
+    const size_t block = ReplayPlayback::blockAt(target);
+    const bool loaded = resimulate([&] {
+        if ((target < gameTime || block > ReplayPlayback::currentBlock()) &&
+            !loadState(ReplayPlayback::seek(block)))
+            return false;
+        uint32_t steps;
+        PlayerInput input;
+        while (gameTime < target && gameState == GameState::PLAYING &&
+               ReplayPlayback::nextTick(steps, input)) {
+            deltaTime = replayStepSeconds(steps);
+            tick(input);
+        }
+        return true;
+    });
+    if (!loaded) {
+        TraceLog(LOG_WARNING, "Replay: keyframe %zu is damaged", block);
+        setGameState(GameState::MAIN_MENU);
+        return;
+    }
+    replayClock = gameTime;
+}
+
+void Game::saveReplay(RunResult result, RunMode mode)
+{
+    const std::string path = Settings::getConfigPath(REPLAY_DIR "/last" REPLAY_EXTENSION);
+    if (!ReplayRecorder::finish(path, result))
+        return;
+
+    // a new record keeps its replay, one per board
+    const size_t board = RunStore::board(currentDifficulty, mode);
+    const auto ranking = RunStore::ranking(board);
+    if (ranking.empty() || !RunStore::isLatest(ranking.front()))
+        return;
+    const std::string bestPath =
+        Settings::getConfigPath(TextFormat(REPLAY_DIR "/best-%zu" REPLAY_EXTENSION, board));
+    std::error_code error;
+    std::filesystem::copy_file(path, bestPath + ".tmp",
+                               std::filesystem::copy_options::overwrite_existing, error);
+    if (!error)
+        std::filesystem::rename(bestPath + ".tmp", bestPath, error);
+    if (error)
+        TraceLog(LOG_WARNING, "Failed to keep the record replay: %s", error.message().c_str());
+}
+
+void Game::startNetGame()
+{
+    // both sides play the host's board, survival escalates with the frame rate of one machine
+    currentDifficulty = Netplay::difficulty();
+    Survival::enabled = false;
+    partner = std::make_unique<Player>(playerTexture, 1);
+    reset();
+    netTick = 0;
+    netClock = 0.f;
+    nextCheck = 0;
+    setGameState(GameState::PLAYING);
+}
+
+void Game::endNetGame()
+{
+    Netplay::close();
+    partner.reset(); // the menu resets the board when the next run starts
+    setGameState(GameState::MAIN_MENU);
+}
+
+void Game::playNet()
+{
+    if (Netplay::state() != NetState::RUNNING) {
+        TraceLog(LOG_WARNING, "Netplay: the connection was lost");
+        endNetGame();
+        return;
+    }
+
+    // fixed ticks, both sides have to simulate exactly the same ones
+    const float tickSeconds = replayStepSeconds(NET_TICK_STEPS);
+    deltaTime = tickSeconds;
+
+    // the peer's real input differed from what was predicted for some ticks, everything
+    // from the first of them is simulated again
+    const uint32_t from = Netplay::takeRollback();
+    if (from < netTick) {
+        PROFILE_ZONE("rollback");
+        const bool loaded = resimulate([&] {
+            if (!loadState(snapshots[from % Netplay::HISTORY]))
+                return false;
+            for (uint32_t t = from; t < netTick; ++t) {
+                if (!simulateNetTick(t) || gameState != GameState::PLAYING) {
+                    netTick = t + (gameState != GameState::PLAYING);
+                    break;
+                }
+            }
+            return true;
+        });
+        if (!loaded) {
+            TraceLog(LOG_ERROR, "Netplay: the snapshot of tick %u is damaged", from);
+            endNetGame();
+            return;
+        }
+    }
+
+    netClock = std::min(netClock + GetFrameTime(), tickSeconds * NET_MAX_PREDICTION);
+    // runs ahead of the peer's input only so far, then waits for it
+    while (netClock >= tickSeconds && gameState == GameState::PLAYING &&
+           netTick < Netplay::confirmedTicks() + NET_MAX_PREDICTION) {
+        PlayerInput input = Player::readInput();
+        if (std::exchange(inputInterrupted, false))
+            input.buttons |= PlayerInput::RESET_TARGET;
+        Netplay::setLocalInput(netTick + NET_INPUT_DELAY, input);
+        if (!simulateNetTick(netTick))
+            break;
+        ++netTick;
+        netClock -= tickSeconds;
+    }
+
+    // the state before a tick is final once the input of every tick before it is confirmed
+    while (nextCheck < netTick && nextCheck <= Netplay::confirmedTicks()) {
+        Netplay::addChecksum(nextCheck, snapshots[nextCheck % Netplay::HISTORY]);
+        nextCheck += NET_CHECK_INTERVAL;
+    }
+}
+
+bool Game::simulateNetTick(uint32_t number)
+{
+    // only predicted ticks can be rolled back to, the checked ones are hashed later
+    std::vector<uint8_t> &snapshot = snapshots[number % Netplay::HISTORY];
+    const bool predicted = number >= Netplay::confirmedTicks();
+    if (predicted || number % NET_CHECK_INTERVAL == 0) {
+        snapshot.clear();
+        saveState(snapshot);
+    }
+
+    // the host is the first player on both sides
+    const PlayerInput local = Netplay::localInput(number);
+    const PlayerInput remote = Netplay::remoteInput(number);
+    const GameState end = Netplay::isHost() ? step(local, remote) : step(remote, local);
+    if (end == GameState::PLAYING)
+        return true;
+    // the end screen, its timer and the hitch log wait for an end the peer's input confirms
+    if (predicted) {
+        loadState(snapshot);
+        return false;
+    }
+    setGameState(end);
+    return true;
+}
+
+Script Game::attackScript(TimerDue resume)
+{
+    // the wave rules are specialized per difficulty at compile time
+    static constexpr void (Game::*spawnWave[])() = {&Game::spawnAttackWave<Difficulty::EASY>,
+                                                    &Game::spawnAttackWave<Difficulty::NORMAL>,
+                                                    &Game::spawnAttackWave<Difficulty::HARD>};
+    for (;;) {
+        if (Survival::enabled) {
+            // the interval and the wave size escalate with the survival level
+            if (resume.tick != 0)
+                co_await ScriptScheduler::resumeAt(std::exchange(resume, {}));
+            else
+                co_await ScriptScheduler::delay(Survival::attackInterval());
+            for (int i = Survival::attacksPerWave(); i > 0; --i)
                 createAttack();
+        } else {
+            if (resume.tick != 0)
+                co_await ScriptScheduler::resumeAt(std::exchange(resume, {}));
+            else
+                co_await ScriptScheduler::delay(0.5f);
+            (this->*spawnWave[static_cast<size_t>(currentDifficulty)])();
         }
-        attackTimer = 0.f;
     }
+}
 
-    // spawn bombs randomly
-    if (bombTimer >= 5.f) {
-        if (GetRandomValue(0, 2) == 0)
+Script Game::bombScript(TimerDue resume)
+{
+    for (;;) {
+        if (resume.tick != 0)
+            co_await ScriptScheduler::resumeAt(std::exchange(resume, {}));
+        else
+            co_await ScriptScheduler::delay(5.f);
+        if (Random::value(0, 2) == 0)
             spawnBomb(); // 33%
-        bombTimer = 0.f;
     }
 }
 
+Script Game::bossPhaseScript()
+{
+    // a restored boss keeps the phase it was saved in. health that crossed a threshold in
+    // the tick before the save changes it on the next tick, the same as it did live
+    if (boss->phaseForHealth() != boss->phase)
+        co_await ScriptScheduler::nextTick();
+    // health moves both ways, HARD regenerates it and survival refills it
+    for (;;) {
+        const BossPhase phase = boss->phaseForHealth();
+        boss->setPhase(phase);
+        co_await ScriptScheduler::until([this, phase] { return boss->phaseForHealth() != phase; });
+    }
+}
+
+bool Game::isRecordedRun() const
+{
+    return !Benchmark::isRunning() && !ReplayPlayback::isActive() && !partner;
+}
+
+const Player &Game::attackTarget() const
+{
+    if (!partner || partner->health <= 0.f)
+        return *player;
+    if (player->health <= 0.f)
+        return *partner;
+    return Random::value(0, 1) == 0 ? *player : *partner;
+}
+
 void Game::createAttack()
 {
-    auto size = static_cast<AttackSize>(GetRandomValue(0, 2));
+    ALLOC_SCOPE(ATTACKS);
+    auto size = static_cast<AttackSize>(Random::value(0, 2));
 
-    const auto [x, y] = Vector2Normalize(player->velocity);
+    const Player &target = attackTarget();
+    const auto [x, y] = Vector2Normalize(target.velocity);
 
     const float attackAreaWidth = movementBounds.right - movementBounds.left;
     const float attackAreaHeight = movementBounds.top;
 
-    const Vector2 playerCenter = {player->position.x + player->texture.width / 2.f,
-                                  player->position.y + player->texture.height / 2.f};
+    const Vector2 playerCenter = {target.position.x + target.texture.width / 2.f,
+                                  target.position.y + target.texture.height / 2.f};
 
     Vector2 attackPos = {playerCenter.x + x * attackAreaWidth / 2.f,
                          playerCenter.y + y * attackAreaHeight / 2.f};
@@ -434,22 +1268,34 @@ void Game::createAttack()
     attackPos.y = std::clamp(attackPos.y, playerCenter.y - attackAreaHeight / 2.f,
                              playerCenter.y + attackAreaHeight / 2.f);
 
-    attackPos.x += GetRandomValue(-ATTACK_OFFSET, ATTACK_OFFSET);
-    attackPos.y += GetRandomValue(-ATTACK_OFFSET, ATTACK_OFFSET);
+    attackPos.x += Random::value(-ATTACK_OFFSET, ATTACK_OFFSET);
+    attackPos.y += Random::value(-ATTACK_OFFSET, ATTACK_OFFSET);
 
-    bossAttacks.emplace_back(std::make_unique<BossAttack>(attackPos, size));
+    if (freeAttacks.empty()) {
+        bossAttacks.emplace_back(std::make_unique<BossAttack>(attackPos, size));
+    } else {
+        bossAttacks.emplace_back(std::move(freeAttacks.back()));
+        freeAttacks.pop_back();
+        bossAttacks.back()->init(attackPos, size);
+    }
 
     TraceLog(LOG_INFO, "Attack created at position: (%f, %f)", attackPos.x, attackPos.y);
 }
 
 void Game::spawnBomb()
 {
+    ALLOC_SCOPE(BOMBS);
     const Vector2 bombPos = {
-        static_cast<float>(GetRandomValue(movementBounds.left, movementBounds.right)),
-        static_cast<float>(GetRandomValue(movementBounds.top, movementBounds.bottom))};
+        static_cast<float>(Random::value(movementBounds.left, movementBounds.right)),
+        static_cast<float>(Random::value(movementBounds.top, movementBounds.bottom))};
 
-    bombs.emplace_back(std::make_unique<Bomb>(
-        bombTexture, Vector2{static_cast<float>(bombPos.x), static_cast<float>(bombPos.y)}));
+    if (freeBombs.empty()) {
+        bombs.emplace_back(std::make_unique<Bomb>(bombTexture, bombPos));
+    } else {
+        bombs.emplace_back(std::move(freeBombs.back()));
+        freeBombs.pop_back();
+        bombs.back()->init(bombPos);
+    }
 
     TraceLog(LOG_INFO, "Bomb spawned at position: (%f, %f)", bombPos.x, bombPos.y);
 }
@@ -460,14 +1306,27 @@ void Game::shakeWindow(float duration, float intensity)
         TraceLog(LOG_INFO, "Screen shake is disabled in settings");
         return;
     }
-    windowPos = GetWindowPosition();
+    if (!isShaking)
+        windowPos = GetWindowPosition();
     shakeEndTime = gameTime + duration;
     shakeIntensity = intensity;
     isShaking = true;
+
+    TimerWheel::cancel(shakeTimer);
+    shakeTimer = TimerWheel::schedule(
+        duration,
+        [](void *self) {
+            auto *game = static_cast<Game *>(self);
+            // reset window position
+            SetWindowPosition(game->windowPos.x, game->windowPos.y);
+            game->isShaking = false;
+        },
+        this);
 }
 
 float Game::drawTextCenter(const char *text, float x, float y, float fontSize, Color color)
 {
+    ALLOC_SCOPE(TEXT);
     const float spacing = fontSize / 10;
     const Vector2 textSize = MeasureTextEx(GetFontDefault(), text, fontSize, spacing);
     const Vector2 position = {x - textSize.x / 2.f, y - textSize.y / 2.f};
@@ -480,12 +1339,14 @@ float Game::drawTextCombined(float x,
                              float fontSize,
                              std::initializer_list<TextSegment> segments)
 {
+    ALLOC_SCOPE(TEXT);
     if (segments.size() == 0)
         return x;
     const float spacing = fontSize / 10;
     const float spaceWidth = fontSize / 2.0f;
 
-    std::vector<Vector2> sizes;
+    FrameVector<Vector2> sizes;
+    sizes.reserve(segments.size());
     float totalWidth = 0;
     float maxHeight = 0;
     for (const auto &segment : segments) {
@@ -514,6 +1375,7 @@ float Game::drawTextCombined(float x,
 
 void Game::marqueeText(const char *text, float y, float fontSize, Color color, float speed)
 {
+    ALLOC_SCOPE(TEXT);
     static float x = 0;
     const int textWidth = MeasureText(text, fontSize);
 
@@ -528,6 +1390,7 @@ void Game::marqueeText(const char *text, float y, float fontSize, Color color, f
 
 void Game::disconnectDiscord()
 {
+    joinDiscordTask();
 #ifdef DISCORD_RPC_ENABLED
     if (discord.connected)
         DiscordRPC_shutdown(&discord);
@@ -535,6 +1398,30 @@ void Game::disconnectDiscord()
 }
 
 void Game::connectDiscord()
+{
+    joinDiscordTask();
+    openDiscord();
+}
+
+void Game::pollDiscord()
+{
+    if (!discordTask.valid() ||
+        discordTask.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return;
+    discordTask.get();
+#ifdef DISCORD_RPC_ENABLED
+    if (discord.connected)
+        DiscordRPC_setActivity(&discord, &discordActivity);
+#endif
+}
+
+void Game::joinDiscordTask()
+{
+    if (discordTask.valid())
+        discordTask.get();
+}
+
+void Game::openDiscord()
 {
 #ifdef DISCORD_RPC_ENABLED
     if (discord.connected) {
@@ -570,6 +1457,11 @@ void Game::connectDiscord()
 #endif
 }
 
+GameState Game::getGameState() const
+{
+    return gameState;
+}
+
 Music *Game::getBGMusic() const
 {
     return bgMusic;
@@ -581,22 +1473,40 @@ void Game::setBGMusic(Music *music)
         bgMusic = music;
 }
 
+void Game::drawBestTime(RunMode mode, float y)
+{
+    const auto ranking = RunStore::ranking(RunStore::board(currentDifficulty, mode));
+    if (ranking.empty())
+        return;
+    if (RunStore::isLatest(ranking.front()))
+        drawTextCenter("Yeni rekor!", SCREEN_DRAW_X, y, 20, GOLD);
+    else
+        drawTextCenter(
+            TextFormat("Rekor: %s", formatTime(RunStore::get(ranking.front()).gameTime)),
+            SCREEN_DRAW_X, y, 20, LIGHTGRAY);
+}
+
 const char *Game::formatTime() const
 {
-    const int minutes = static_cast<int>(gameTime / 60);
-    const int seconds = static_cast<int>(gameTime) % 60;
-    const int milliseconds = static_cast<int>(gameTime * 1000) % 1000 / 10;
+    return formatTime(gameTime);
+}
+
+const char *Game::formatTime(float time)
+{
+    const int minutes = static_cast<int>(time / 60);
+    const int seconds = static_cast<int>(time) % 60;
+    const int milliseconds = static_cast<int>(time * 1000) % 1000 / 10;
     return TextFormat("%02d:%02d.%02d", minutes, seconds, milliseconds);
 }
 
 void Game::setDiscordActivity(const char *state, const char *details, const float startTimestamp)
 {
 #ifdef DISCORD_RPC_ENABLED
-    if (discord.connected) {
-        discordActivity.state = state;
-        discordActivity.details = details;
-        discordActivity.startTimestamp = static_cast<int64_t>(startTimestamp);
+    // kept while the startup connect runs, pollDiscord() sends it when that's done
+    discordActivity.state = state;
+    discordActivity.details = details;
+    discordActivity.startTimestamp = static_cast<int64_t>(startTimestamp);
+    if (!discordTask.valid() && discord.connected)
         DiscordRPC_setActivity(&discord, &discordActivity);
-    }
 #endif
 }
@@ -0,0 +1,70 @@
+#include "Ghost.hpp"
+
+#include "Constants.hpp"
+#include "Profiler.hpp"
+#include "Settings.hpp"
+
+ReplayFile Ghost::file{};
+ReplayCursor Ghost::cursor{};
+std::unique_ptr<Player> Ghost::player{};
+float Ghost::time = 0.f;
+bool Ghost::finished = true;
+
+void Ghost::start(size_t board, const Texture2D &texture)
+{
+    stop();
+    const std::string path =
+        Settings::getConfigPath(TextFormat(REPLAY_DIR "/best-%zu" REPLAY_EXTENSION, board));
+    if (!FileExists(path.c_str()) || !file.open(path))
+        return;
+
+    // every replay starts right after Game::reset(), where the player is fresh
+    cursor.seek(file, 0);
+    if (!player)
+        player = std::make_unique<Player>(texture);
+    player->init();
+    time = 0.f;
+    finished = false;
+}
+
+void Ghost::stop()
+{
+    cursor = {};
+    file.close();
+    finished = true;
+}
+
+void Ghost::update(float gameTime)
+{
+    if (finished)
+        return;
+
+    const uint64_t begin = Profiler::now();
+    uint32_t steps;
+    PlayerInput input;
+    for (int ticks = 0; time < gameTime; ++ticks) {
+        if (ticks == MAX_TICKS_PER_FRAME ||
+            (ticks % 8 == 7 && Profiler::now() - begin > FRAME_BUDGET_NS))
+            return;
+        if (!cursor.next(steps, input)) {
+            finished = true;
+            return;
+        }
+        const float deltaTime = replayStepSeconds(steps);
+        player->update(input, deltaTime);
+        time += deltaTime;
+    }
+}
+
+void Ghost::draw()
+{
+    if (finished)
+        return;
+
+    const Texture2D &texture = player->texture;
+    const Rectangle src = {0.f, 0.f, static_cast<float>(texture.width),
+                           static_cast<float>(texture.height)};
+    const Rectangle dest = {player->position.x, player->position.y, PLAYER_SIZE, PLAYER_SIZE};
+    DrawTexturePro(texture, src, dest, {PLAYER_SIZE / 2.f, PLAYER_SIZE / 2.f}, 0.f,
+                   Fade(SKYBLUE, GHOST_ALPHA));
+}
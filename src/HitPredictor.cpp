@@ -0,0 +1,80 @@
+#include "HitPredictor.hpp"
+
+#include "Constants.hpp"
+#include "raymath.h"
+
+#include <cmath>
+
+namespace {
+// how far the player may drift from the predicted path before every hit is re-solved
+constexpr float PATH_TOLERANCE = 0.5f;
+constexpr float HIT_RADIUS = BULLET_SIZE + PLAYER_COLLISION_RADIUS;
+} // namespace
+
+bool HitPredictor::enabled = false;
+bool HitPredictor::pathChanged = false;
+bool HitPredictor::hasPath = false;
+PlayerPath HitPredictor::path{};
+
+void HitPredictor::reset()
+{
+    hasPath = false;
+    pathChanged = false;
+    path = {};
+}
+
+void HitPredictor::save(StateWriter &writer)
+{
+    writer.write(hasPath);
+    writer.write(pathChanged);
+    writer.write(path.origin);
+    writer.write(path.velocity);
+    writer.write(path.time);
+}
+
+void HitPredictor::load(StateReader &reader)
+{
+    hasPath = reader.read<bool>();
+    pathChanged = reader.read<bool>();
+    path.origin = reader.read<Vector2>();
+    path.velocity = reader.read<Vector2>();
+    path.time = reader.read<float>();
+}
+
+void HitPredictor::updatePath(const Player &player, float now, float deltaTime)
+{
+    pathChanged = !hasPath || Vector2DistanceSqr(path.at(now), player.position) >
+                                  PATH_TOLERANCE * PATH_TOLERANCE;
+    if (!pathChanged)
+        return;
+
+    // Player::velocity is the displacement of the last frame
+    path = {.origin = player.position,
+            .velocity = deltaTime > 0.f ? Vector2Scale(player.velocity, 1.f / deltaTime)
+                                        : Vector2{0.f, 0.f},
+            .time = now};
+    hasPath = true;
+}
+
+float HitPredictor::solve(const Bullet &bullet, float from)
+{
+    // |d + v * s|^2 = r^2, d and v are relative to the player at time "from"
+    const Vector2 d = Vector2Subtract(bullet.positionAt(from), path.at(from));
+    const Vector2 v = Vector2Subtract(bullet.getVelocity(), path.velocity);
+
+    const float c = Vector2DotProduct(d, d) - HIT_RADIUS * HIT_RADIUS;
+    if (c <= 0.f)
+        return from; // already overlapping
+
+    const float a = Vector2DotProduct(v, v);
+    const float b = Vector2DotProduct(d, v);
+    if (a <= 0.f || b >= 0.f)
+        return INFINITY; // not moving closer
+
+    const float discriminant = b * b - a * c;
+    if (discriminant < 0.f)
+        return INFINITY; // closest approach is outside the hit radius
+
+    const float hitTime = from + (-b - sqrtf(discriminant)) / a;
+    return hitTime < bullet.expireTime ? hitTime : INFINITY;
+}
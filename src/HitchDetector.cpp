@@ -0,0 +1,300 @@
+#include "HitchDetector.hpp"
+
+#include "Game.hpp"
+#include "Profiler.hpp"
+#include "Settings.hpp"
+#include "raylib.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+float HitchDetector::factor = HITCH_DEFAULT_FACTOR;
+thread_local bool HitchDetector::watching = false;
+thread_local bool HitchDetector::suspended = false;
+std::array<float, HitchDetector::HISTORY> HitchDetector::history{};
+size_t HitchDetector::historyCount = 0;
+size_t HitchDetector::historyNext = 0;
+uint64_t HitchDetector::lastFrameEnd = 0;
+std::array<HitchDetector::Zone, HitchDetector::MAX_ZONES> HitchDetector::zones{};
+size_t HitchDetector::zoneCount = 0;
+std::array<uint64_t, HitchDetector::MAX_DEPTH> HitchDetector::childTime{};
+size_t HitchDetector::depth = 0;
+uint64_t HitchDetector::zonedTime = 0;
+float HitchDetector::usualOutside = 0.f;
+size_t HitchDetector::bullets = 0;
+size_t HitchDetector::attacks = 0;
+size_t HitchDetector::bombs = 0;
+size_t HitchDetector::recycled = 0;
+std::atomic<uint32_t> HitchDetector::logLines{0};
+std::atomic<uint64_t> HitchDetector::logTime{0};
+std::array<HitchDetector::Snapshot, HitchDetector::MAX_PENDING> HitchDetector::pending{};
+size_t HitchDetector::pendingCount = 0;
+uint32_t HitchDetector::dropped = 0;
+
+namespace {
+// a hitch has to be noticeable, 3x a 2 ms frame is still smooth
+constexpr float MIN_HITCH_SECONDS = 1.f / 60.f;
+constexpr float USUAL_WEIGHT = 0.05f;
+// something took part in a hitch when it accounts for this much of the extra time
+constexpr float INVOLVED_SHARE = 0.25f;
+constexpr uint32_t LOG_BURST_LINES = 8;
+constexpr size_t MASS_RECYCLE = 16;
+constexpr uintmax_t MAX_LOG_BYTES = 1 << 20; // the log starts over past this
+} // namespace
+
+// same output as raylib's own logger, which is bypassed once a callback is set
+void HitchDetector::countLog(int logLevel, const char *text, va_list args)
+{
+    const uint64_t begin = Profiler::now();
+
+    const char *prefix = "";
+    switch (logLevel) {
+        case LOG_TRACE:
+            prefix = "TRACE: ";
+            break;
+        case LOG_DEBUG:
+            prefix = "DEBUG: ";
+            break;
+        case LOG_INFO:
+            prefix = "INFO: ";
+            break;
+        case LOG_WARNING:
+            prefix = "WARNING: ";
+            break;
+        case LOG_ERROR:
+            prefix = "ERROR: ";
+            break;
+        case LOG_FATAL:
+            prefix = "FATAL: ";
+            break;
+        default:
+            break;
+    }
+
+    // one printf per line so lines of the loader threads don't interleave
+    char message[512];
+    vsnprintf(message, sizeof(message), text, args);
+    printf("%s%s\n", prefix, message);
+    fflush(stdout);
+
+    if (logLevel == LOG_FATAL)
+        exit(EXIT_FAILURE);
+
+    if (suspended)
+        return;
+    logLines.fetch_add(1, std::memory_order_relaxed);
+    logTime.fetch_add(Profiler::now() - begin, std::memory_order_relaxed);
+}
+
+void HitchDetector::init(float factor)
+{
+    HitchDetector::factor = factor > 1.f ? factor : HITCH_DEFAULT_FACTOR;
+    watching = true;
+    SetTraceLogCallback(countLog);
+}
+
+void HitchDetector::reset()
+{
+    historyCount = 0;
+    historyNext = 0;
+    lastFrameEnd = 0;
+}
+
+void HitchDetector::recordEntities(size_t bullets, size_t attacks, size_t bombs)
+{
+    if (suspended)
+        return;
+    HitchDetector::bullets = bullets;
+    HitchDetector::attacks = attacks;
+    HitchDetector::bombs = bombs;
+}
+
+void HitchDetector::enterZone()
+{
+    if (depth < MAX_DEPTH)
+        childTime[depth] = 0;
+    ++depth;
+}
+
+void HitchDetector::exitZone(const char *name, uint64_t duration)
+{
+    if (depth == 0)
+        return; // opened before init()
+    --depth;
+
+    const uint64_t children = depth < MAX_DEPTH ? childTime[depth] : 0;
+    if (depth == 0)
+        zonedTime += duration;
+    else if (depth - 1 < MAX_DEPTH)
+        childTime[depth - 1] += duration;
+
+    Zone *zone = nullptr;
+    for (size_t i = 0; i < zoneCount; ++i) {
+        if (zones[i].name == name) {
+            zone = &zones[i];
+            break;
+        }
+    }
+    if (!zone) {
+        if (zoneCount == MAX_ZONES)
+            return; // counted as time outside the zones
+        zone = &zones[zoneCount++];
+        *zone = {name, 0, 0.f};
+    }
+    zone->self += duration > children ? duration - children : 0;
+}
+
+void HitchDetector::endFrame()
+{
+    const uint64_t now = Profiler::now();
+
+    if (lastFrameEnd != 0) {
+        const float frameTime = static_cast<float>(now - lastFrameEnd) * 1e-9f;
+
+        bool hitch = false;
+        if (historyCount == HISTORY) {
+            const float medianTime = median();
+            hitch = frameTime > medianTime * factor && frameTime > MIN_HITCH_SECONDS;
+            if (hitch)
+                snapshot(frameTime, medianTime);
+        }
+
+        // a slower stretch that lasts becomes the new normal, only spikes are hitches
+        history[historyNext] = frameTime;
+        historyNext = (historyNext + 1) % HISTORY;
+        historyCount = std::min(historyCount + 1, HISTORY);
+
+        // the usual cost of a zone isn't dragged up by the hitches themselves
+        if (!hitch) {
+            for (size_t i = 0; i < zoneCount; ++i) {
+                const float ms = static_cast<float>(zones[i].self) * 1e-6f;
+                zones[i].usual += (ms - zones[i].usual) * USUAL_WEIGHT;
+            }
+            const float outsideMs =
+                frameTime * 1000.f - static_cast<float>(zonedTime) * 1e-6f;
+            usualOutside += (outsideMs - usualOutside) * USUAL_WEIGHT;
+        }
+    }
+
+    // the next frame starts here
+    lastFrameEnd = now;
+    for (size_t i = 0; i < zoneCount; ++i)
+        zones[i].self = 0;
+    zonedTime = 0;
+    bullets = 0;
+    attacks = 0;
+    bombs = 0;
+    recycled = 0;
+    logLines.store(0, std::memory_order_relaxed);
+    logTime.store(0, std::memory_order_relaxed);
+}
+
+float HitchDetector::median()
+{
+    std::array<float, HISTORY> sorted = history;
+    const auto middle = sorted.begin() + HISTORY / 2;
+    std::nth_element(sorted.begin(), middle, sorted.end());
+    return *middle;
+}
+
+void HitchDetector::snapshot(float frameTime, float medianTime)
+{
+    if (pendingCount == MAX_PENDING) {
+        ++dropped;
+        return;
+    }
+
+    Snapshot &snapshot = pending[pendingCount++];
+    snapshot.wallTime = std::time(nullptr);
+    snapshot.gameTime = Game::gameTime;
+    snapshot.frameMs = frameTime * 1000.f;
+    snapshot.medianMs = medianTime * 1000.f;
+    snapshot.bullets = bullets;
+    snapshot.attacks = attacks;
+    snapshot.bombs = bombs;
+    snapshot.recycled = recycled;
+    snapshot.logLines = logLines.load(std::memory_order_relaxed);
+    snapshot.logMs = static_cast<float>(logTime.load(std::memory_order_relaxed)) * 1e-6f;
+
+    snapshot.zoneCount = 0;
+    for (size_t i = 0; i < zoneCount; ++i) {
+        if (zones[i].self != 0)
+            snapshot.zones[snapshot.zoneCount++] = {
+                zones[i].name, static_cast<float>(zones[i].self) * 1e-6f, zones[i].usual};
+    }
+    snapshot.zones[snapshot.zoneCount++] = {
+        "outside zones", snapshot.frameMs - static_cast<float>(zonedTime) * 1e-6f, usualOutside};
+}
+
+void HitchDetector::flush()
+{
+    if (pendingCount == 0)
+        return;
+
+    const std::string path = Settings::getConfigPath(HITCH_LOG_FILE_NAME);
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+    const bool tooLarge = std::filesystem::file_size(path, error) > MAX_LOG_BYTES && !error;
+
+    std::ofstream file(path, tooLarge ? std::ios::trunc : std::ios::app);
+    if (!file.is_open()) {
+        TraceLog(LOG_WARNING, "Failed to open hitch log for writing: %s", path.c_str());
+        pendingCount = 0;
+        return;
+    }
+
+    for (size_t i = 0; i < pendingCount; ++i) {
+        Snapshot &hitch = pending[i];
+        const float extraMs = hitch.frameMs - hitch.medianMs;
+
+        // the zone that went furthest over its usual cost comes first
+        const auto zonesEnd = hitch.zones.begin() + static_cast<std::ptrdiff_t>(hitch.zoneCount);
+        std::sort(hitch.zones.begin(), zonesEnd, [](const ZoneSample &a, const ZoneSample &b) {
+            return a.ms - a.usualMs > b.ms - b.usualMs;
+        });
+        float musicExtraMs = 0.f;
+        for (auto zone = hitch.zones.begin(); zone != zonesEnd; ++zone) {
+            if (std::strcmp(zone->name, "UpdateMusicStream") == 0)
+                musicExtraMs = zone->ms - zone->usualMs;
+        }
+        const bool music = musicExtraMs >= extraMs * INVOLVED_SHARE;
+        const bool logBurst =
+            hitch.logLines >= LOG_BURST_LINES || hitch.logMs >= extraMs * INVOLVED_SHARE;
+        const bool massRecycle = hitch.recycled >= MASS_RECYCLE;
+
+        char wallTime[32];
+        std::strftime(wallTime, sizeof(wallTime), "%Y-%m-%d %H:%M:%S",
+                      std::localtime(&hitch.wallTime));
+
+        file << TextFormat("%s  %.1f ms frame, %.1fx the %.1f ms median, game time %.1f s\n",
+                           wallTime, hitch.frameMs, hitch.frameMs / hitch.medianMs,
+                           hitch.medianMs, hitch.gameTime);
+        file << TextFormat("  cause: %s, %.2f ms, usually %.2f ms\n", hitch.zones[0].name,
+                           hitch.zones[0].ms, hitch.zones[0].usualMs);
+        file << TextFormat("  entities: %zu bullets, %zu attacks, %zu bombs\n", hitch.bullets,
+                           hitch.attacks, hitch.bombs);
+        file << TextFormat("  recycled: %zu attacks and bombs%s\n", hitch.recycled,
+                           massRecycle ? " (mass erase)" : "");
+        file << TextFormat("  TraceLog: %u lines, %.2f ms%s\n", hitch.logLines, hitch.logMs,
+                           logBurst ? " (burst)" : "");
+        file << TextFormat("  UpdateMusicStream: %s\n", music ? "involved" : "not involved");
+        file << "  zones (self time):\n";
+        for (auto zone = hitch.zones.begin(); zone != zonesEnd; ++zone)
+            file << TextFormat("    %-20s %7.2f ms, usually %.2f ms\n", zone->name, zone->ms,
+                               zone->usualMs);
+    }
+    if (dropped > 0)
+        file << TextFormat("%u more hitches were not recorded\n", dropped);
+    file.close();
+
+    TraceLog(LOG_INFO, "Wrote %zu hitches to %s", pendingCount + dropped, path.c_str());
+    pendingCount = 0;
+    dropped = 0;
+    // this frame did the writing, it would show up as a hitch itself
+    lastFrameEnd = 0;
+}
@@ -80,6 +80,18 @@ bool Input::isResetKey()
     return IsKeyPressed(KEY_R) || IsGamepadButtonPressed(0, GAMEPAD_BUTTON_RIGHT_FACE_DOWN);
 }
 
+bool Input::isTraceKey()
+{
+    // starts or stops a trace capture, see Profiler
+    return IsKeyPressed(KEY_F9);
+}
+
+bool Input::isCaptureKey()
+{
+    // starts or stops recording a video, see FrameCapture
+    return IsKeyPressed(KEY_F10);
+}
+
 bool Input::isEnterOrSpace()
 {
     // gamepad X button
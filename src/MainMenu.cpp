@@ -3,12 +3,17 @@
 #include "Difficulty.hpp"
 #include "Game.hpp"
 #include "Input.hpp"
+#include "RunStore.hpp"
 #include "Settings.hpp"
+#include "Survival.hpp"
+
+#include <ctime>
 
 extern Game game;
 
 int MainMenu::selectedOption = 0;
 int MainMenu::selectedDifficulty = 1; // default to NORMAL difficulty
+int MainMenu::selectedBoard = 1;
 MainMenuState MainMenu::state = MainMenuState::MAIN_MENU;
 
 void MainMenu::draw()
@@ -33,6 +38,9 @@ void MainMenu::draw()
         case MainMenuState::SETTINGS:
             Settings::draw();
             break;
+        case MainMenuState::LEADERBOARD:
+            drawLeaderboard();
+            break;
     }
 }
 
@@ -53,6 +61,9 @@ void MainMenu::handleInput()
         case MainMenuState::SETTINGS:
             Settings::handleInput();
             break;
+        case MainMenuState::LEADERBOARD:
+            handleLeaderboardInput();
+            break;
     }
 }
 
@@ -62,12 +73,14 @@ void MainMenu::drawMainMenu()
 
     Game::drawTextCenter("Oyuna Basla", SCREEN_DRAW_X, SCREEN_DRAW_Y + TEXT_HEIGHT * 2, 20,
                          selectedOption == 0 ? GREEN : GRAY);
-    Game::drawTextCenter("Ayarlar", SCREEN_DRAW_X, SCREEN_DRAW_Y + TEXT_HEIGHT * 3, 20,
-                         selectedOption == 1 ? YELLOW : GRAY);
-    Game::drawTextCenter("Yapimcilar", SCREEN_DRAW_X, SCREEN_DRAW_Y + TEXT_HEIGHT * 4, 20,
-                         selectedOption == 2 ? RED : GRAY);
-    Game::drawTextCenter("Cikis", SCREEN_DRAW_X, SCREEN_DRAW_Y + TEXT_HEIGHT * 5, 20,
-                         selectedOption == 3 ? DARKRED : GRAY);
+    Game::drawTextCenter("Skor Tablosu", SCREEN_DRAW_X, SCREEN_DRAW_Y + TEXT_HEIGHT * 3, 20,
+                         selectedOption == 1 ? GOLD : GRAY);
+    Game::drawTextCenter("Ayarlar", SCREEN_DRAW_X, SCREEN_DRAW_Y + TEXT_HEIGHT * 4, 20,
+                         selectedOption == 2 ? YELLOW : GRAY);
+    Game::drawTextCenter("Yapimcilar", SCREEN_DRAW_X, SCREEN_DRAW_Y + TEXT_HEIGHT * 5, 20,
+                         selectedOption == 3 ? RED : GRAY);
+    Game::drawTextCenter("Cikis", SCREEN_DRAW_X, SCREEN_DRAW_Y + TEXT_HEIGHT * 6, 20,
+                         selectedOption == 4 ? DARKRED : GRAY);
 
     Game::drawTextCombined(SCREEN_DRAW_X, SCREEN_HEIGHT - TEXT_HEIGHT * 2, 20,
                            {{"XielQ tarafindan", GRAY}, {"sevgi", RED}, {"ile yapildi", GRAY}});
@@ -88,17 +101,23 @@ void MainMenu::handleMainMenuInput()
             case 0: // Oyun Baslat
                 state = MainMenuState::SELECT_DIFFICULTY;
                 break;
-            case 1: // Ayarlar
+            case 1: // Skor Tablosu
+                // the board of the last played difficulty
+                selectedBoard = static_cast<int>(RunStore::board(
+                    currentDifficulty, Survival::enabled ? RunMode::SURVIVAL : RunMode::NORMAL));
+                state = MainMenuState::LEADERBOARD;
+                break;
+            case 2: // Ayarlar
                 Settings::previousGameState = GameState::MAIN_MENU;
                 Settings::selectedOption = 0;
                 Settings::menuOption = 0;
                 Settings::tempConfig = Settings::config; // reset temp config to current config
                 state = MainMenuState::SETTINGS;
                 break;
-            case 2: // Yapimcilar
+            case 3: // Yapimcilar
                 state = MainMenuState::CREDITS;
                 break;
-            case 3: // Cikis
+            case 4: // Cikis
                 game.cleanup();
                 break;
             default:
@@ -118,6 +137,8 @@ void MainMenu::drawDifficultySelection()
                                          SCREEN_DRAW_Y + TEXT_HEIGHT * 1, 20, YELLOW);
     float hardX = Game::drawTextCenter("ULKUCU VATANDAS", SCREEN_DRAW_X,
                                        SCREEN_DRAW_Y + TEXT_HEIGHT * 2, 20, DARKRED);
+    float survivalX = Game::drawTextCenter("Hayatta Kal", SCREEN_DRAW_X,
+                                           SCREEN_DRAW_Y + TEXT_HEIGHT * 3, 20, ORANGE);
 
     auto calculateDiff = [](float x) -> float {
         return (x - SCREEN_DRAW_X) + 15.f; // adjust the difficulty indicator position
@@ -152,12 +173,21 @@ void MainMenu::drawDifficultySelection()
             Game::drawTextCenter("sana guveniyoruz kaptan o7", SCREEN_DRAW_X,
                                  SCREEN_HEIGHT - TEXT_HEIGHT * 1, 20, DARKRED);
             break;
+        case 3: // Survival
+            Game::drawTextCenter("-", SCREEN_DRAW_X - calculateDiff(survivalX),
+                                 SCREEN_DRAW_Y + TEXT_HEIGHT * 3, 20, ORANGE);
+
+            Game::drawTextCenter("Boss olmez, saldirilar her 15 saniyede daha da artar",
+                                 SCREEN_DRAW_X, SCREEN_HEIGHT - TEXT_HEIGHT * 2, 20, LIGHTGRAY);
+            Game::drawTextCenter("ne kadar dayanabilirsin?", SCREEN_DRAW_X,
+                                 SCREEN_HEIGHT - TEXT_HEIGHT * 1, 20, ORANGE);
+            break;
         default:
             break;
     }
 
     Game::drawTextCenter("Geri Don", SCREEN_DRAW_X, SCREEN_HEIGHT - TEXT_HEIGHT * 4, 20,
-                         selectedDifficulty == 3 ? YELLOW : GRAY);
+                         selectedDifficulty == 4 ? YELLOW : GRAY);
 }
 
 void MainMenu::handleDifficultyInput()
@@ -173,23 +203,28 @@ void MainMenu::handleDifficultyInput()
         selectedDifficulty = 1;
     if (Input::isKeyPressed(KEY_THREE))
         selectedDifficulty = 2;
+    if (Input::isKeyPressed(KEY_FOUR))
+        selectedDifficulty = 3;
 
     if (Input::isEnterOrSpace() || Input::isArrowLeft() || Input::isArrowRight()) {
-        if (selectedDifficulty == 3) { // Geri don
+        if (selectedDifficulty == 4) { // Geri don
             state = MainMenuState::MAIN_MENU;
             selectedDifficulty = 1; // reset selected difficulty to NORMAL
         } else {
             Input::lockMouse();
-            currentDifficulty = static_cast<Difficulty>(selectedDifficulty);
+            // survival escalates from the HARD rules
+            Survival::enabled = selectedDifficulty == 3;
+            currentDifficulty =
+                Survival::enabled ? Difficulty::HARD : static_cast<Difficulty>(selectedDifficulty);
             game.reset();
             game.setGameState(GameState::PLAYING);
         }
     }
 
     if (Input::isArrowUp())
-        selectedDifficulty = (selectedDifficulty - 1 + 4) % 4;
+        selectedDifficulty = (selectedDifficulty - 1 + 5) % 5;
     if (Input::isArrowDown())
-        selectedDifficulty = (selectedDifficulty + 1) % 4;
+        selectedDifficulty = (selectedDifficulty + 1) % 5;
 }
 
 void MainMenu::drawCredits()
@@ -231,3 +266,55 @@ void MainMenu::drawCredits()
     Game::drawTextCenter("Bu oyun tamamiyla eglence amaciyla yapilmistir", SCREEN_DRAW_X,
                          SCREEN_HEIGHT - TEXT_HEIGHT * 1, 20, GRAY);
 }
+
+void MainMenu::drawLeaderboard()
+{
+    static constexpr const char *boardNames[] = {"Kurt vatandas", "Turk vatandas",
+                                                 "ULKUCU VATANDAS", "Hayatta Kal"};
+    static constexpr Color boardColors[] = {GREEN, YELLOW, DARKRED, ORANGE};
+    static_assert(std::size(boardNames) == RunStore::BOARD_COUNT);
+
+    Game::drawTextCenter("Skor Tablosu", SCREEN_DRAW_X, SCREEN_DRAW_Y + TEXT_HEIGHT * -2, 20,
+                         WHITE);
+    Game::drawTextCenter(TextFormat("< %s >", boardNames[selectedBoard]), SCREEN_DRAW_X,
+                         SCREEN_DRAW_Y + TEXT_HEIGHT * -1, 20, boardColors[selectedBoard]);
+
+    // the ranking is kept sorted, only the rows on screen are looked at
+    const auto ranking = RunStore::ranking(static_cast<size_t>(selectedBoard));
+    if (ranking.empty()) {
+        Game::drawTextCenter("Henuz kayit yok", SCREEN_DRAW_X, SCREEN_DRAW_Y + TEXT_HEIGHT * 1,
+                             20, GRAY);
+    }
+    const bool survival = selectedBoard == static_cast<int>(RunStore::BOARD_COUNT) - 1;
+    for (int row = 0; row < leaderboardRows && row < static_cast<int>(ranking.size()); ++row) {
+        const RunRecord &run = RunStore::get(ranking[row]);
+        const auto timestamp = static_cast<std::time_t>(run.timestamp);
+        char date[16];
+        std::strftime(date, sizeof(date), "%d.%m.%Y", std::localtime(&timestamp));
+
+        const char *text =
+            survival ? TextFormat("%2d. %s  Seviye %u  %s", row + 1, Game::formatTime(run.gameTime),
+                                  run.survivalLevel, date)
+                     : TextFormat("%2d. %s  %s", row + 1, Game::formatTime(run.gameTime), date);
+        Game::drawTextCenter(text, SCREEN_DRAW_X, SCREEN_DRAW_Y + TEXT_HEIGHT * row, 20,
+                             row == 0 ? GOLD : LIGHTGRAY);
+    }
+
+    Game::drawTextCenter(
+        TextFormat("%zu oyun oynandi, ESC ile geri don",
+                   RunStore::runCount(static_cast<size_t>(selectedBoard))),
+        SCREEN_DRAW_X, SCREEN_HEIGHT - TEXT_HEIGHT * 1, 20, GRAY);
+}
+
+void MainMenu::handleLeaderboardInput()
+{
+    constexpr int boards = static_cast<int>(RunStore::BOARD_COUNT);
+
+    if (Input::isEscapeKey() || Input::isEnterOrSpace())
+        state = MainMenuState::MAIN_MENU;
+
+    if (Input::isArrowLeft() || Input::isArrowUp())
+        selectedBoard = (selectedBoard - 1 + boards) % boards;
+    if (Input::isArrowRight() || Input::isArrowDown())
+        selectedBoard = (selectedBoard + 1) % boards;
+}
@@ -0,0 +1,163 @@
+#include "MusicCache.hpp"
+
+#include "Settings.hpp"
+
+#include <cinttypes>
+#include <cstdio>
+#include <filesystem>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool MusicCache::enabled = true;
+std::vector<MusicCache::Mapping> MusicCache::mappings{};
+std::mutex MusicCache::mappingsMutex{};
+
+Music MusicCache::load(const char *path)
+{
+    if (!enabled)
+        return LoadMusicStream(path);
+
+    int sourceSize = 0;
+    unsigned char *source = LoadFileData(path, &sourceSize);
+    if (!source)
+        return LoadMusicStream(path);
+
+    // bg_music.mp3 -> music-cache/bg_music-<hash>.wav
+    const std::string stem = std::filesystem::path(path).stem().string();
+    char fileName[128];
+    std::snprintf(fileName, sizeof(fileName), MUSIC_CACHE_DIR "/%s-%016" PRIx64 ".wav",
+                  stem.c_str(), hashFile(source, static_cast<size_t>(sourceSize)));
+    const std::string cachePath = Settings::getConfigPath(fileName);
+
+    const bool cached = FileExists(cachePath.c_str()) ||
+                        decode(GetFileExtension(path), source, sourceSize, cachePath);
+    UnloadFileData(source);
+    if (!cached)
+        return LoadMusicStream(path);
+
+    const Mapping mapping = map(cachePath);
+    if (!mapping.data)
+        return LoadMusicStream(path);
+
+    // raylib streams wav straight out of the given memory
+    Music music =
+        LoadMusicStreamFromMemory(".wav", mapping.data, static_cast<int>(mapping.size));
+    if (!IsMusicValid(music)) {
+        TraceLog(LOG_WARNING, "Music cache: %s is unreadable, decoding again next time",
+                 cachePath.c_str());
+        std::error_code error;
+        std::filesystem::remove(cachePath, error);
+        unmap(mapping);
+        return LoadMusicStream(path);
+    }
+
+    const std::lock_guard lock(mappingsMutex);
+    mappings.push_back(mapping);
+    return music;
+}
+
+void MusicCache::release()
+{
+    const std::lock_guard lock(mappingsMutex);
+    for (const Mapping &mapping : mappings)
+        unmap(mapping);
+    mappings.clear();
+}
+
+uint64_t MusicCache::hashFile(const unsigned char *data, size_t size)
+{
+    // fnv-1a, only used to notice a replaced track
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+bool MusicCache::decode(const char *fileType,
+                        const unsigned char *source,
+                        int sourceSize,
+                        const std::string &path)
+{
+    const std::filesystem::path cachePath(path);
+    const std::string name = cachePath.stem().string();
+    const std::string prefix = name.substr(0, name.rfind('-') + 1);
+    // ExportWave picks the format by the extension, so the temporary name ends in .wav too.
+    // it's written next to the final name and renamed, a crash never leaves a truncated cache
+    const std::filesystem::path temporary =
+        cachePath.parent_path() / (name + ".tmp" + cachePath.extension().string());
+
+    std::error_code error;
+    std::filesystem::create_directories(cachePath.parent_path(), error);
+
+    // a cache file of an older version of the same track is never read again. so is a
+    // temporary one a crash left behind, this one's is simply overwritten
+    for (const auto &entry : std::filesystem::directory_iterator(cachePath.parent_path(), error)) {
+        if (entry.path().filename().string().starts_with(prefix) && entry.path() != cachePath &&
+            entry.path() != temporary)
+            std::filesystem::remove(entry.path(), error);
+    }
+
+    Wave wave = LoadWaveFromMemory(fileType, source, sourceSize);
+    if (!IsWaveValid(wave)) {
+        TraceLog(LOG_WARNING, "Music cache: failed to decode %s", path.c_str());
+        return false;
+    }
+    WaveFormat(&wave, static_cast<int>(wave.sampleRate), 16, static_cast<int>(wave.channels));
+
+    const bool exported = ExportWave(wave, temporary.string().c_str());
+    UnloadWave(wave);
+    if (exported)
+        std::filesystem::rename(temporary, cachePath, error);
+    if (!exported || error) {
+        TraceLog(LOG_WARNING, "Music cache: failed to write %s", path.c_str());
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+
+    TraceLog(LOG_INFO, "Music cache: decoded %s", path.c_str());
+    return true;
+}
+
+MusicCache::Mapping MusicCache::map(const std::string &path)
+{
+#ifdef _WIN32
+    // no mmap, the decoded file is read into memory once instead
+    int size = 0;
+    unsigned char *data = LoadFileData(path.c_str(), &size);
+    return {data, static_cast<size_t>(size)};
+#else
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return {nullptr, 0};
+
+    struct stat info = {};
+    void *data = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+        data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        TraceLog(LOG_WARNING, "Music cache: failed to map %s", path.c_str());
+        return {nullptr, 0};
+    }
+
+    // playback reads front to back, let the kernel read ahead
+    madvise(data, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+    return {static_cast<unsigned char *>(data), static_cast<size_t>(info.st_size)};
+#endif
+}
+
+void MusicCache::unmap(const Mapping &mapping)
+{
+#ifdef _WIN32
+    UnloadFileData(mapping.data);
+#else
+    munmap(mapping.data, mapping.size);
+#endif
+}
@@ -0,0 +1,499 @@
+#include "Netplay.hpp"
+
+// winsock drags in the windows headers, keep the parts that clash with raylib out
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOGDI
+#define NOUSER
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "raylib.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <utility>
+
+NetState Netplay::netState = NetState::OFF;
+bool Netplay::hosting = false;
+intptr_t Netplay::socketHandle = -1;
+uint16_t Netplay::localPort = 0;
+uint32_t Netplay::peerAddress = 0;
+uint16_t Netplay::peerPort = 0;
+Netplay::Clock::time_point Netplay::lastReceived{};
+Netplay::Clock::time_point Netplay::lastHello{};
+uint64_t Netplay::sessionSeed = 0;
+Difficulty Netplay::sessionDifficulty = Difficulty::NORMAL;
+std::array<PlayerInput, Netplay::HISTORY> Netplay::localInputs{};
+uint32_t Netplay::localTicks = 0;
+uint32_t Netplay::remoteAck = 0;
+std::array<PlayerInput, Netplay::HISTORY> Netplay::remoteInputs{};
+uint32_t Netplay::remoteTicks = 0;
+std::array<PlayerInput, Netplay::HISTORY> Netplay::predictions{};
+uint32_t Netplay::predictedTicks = 0;
+uint32_t Netplay::rollbackTick = Netplay::NO_ROLLBACK;
+std::array<Netplay::Checksum, 4> Netplay::checksums{};
+size_t Netplay::checksumCount = 0;
+Netplay::Checksum Netplay::peerChecksum{};
+uint32_t Netplay::rollbacks = 0;
+bool Netplay::desynced = false;
+std::chrono::milliseconds Netplay::shimDelay{0};
+int Netplay::shimLoss = 0;
+std::vector<Netplay::DelayedPacket> Netplay::delayed{};
+std::vector<uint8_t> Netplay::packet{};
+
+namespace {
+constexpr uint32_t PACKET_MAGIC = 0x504E4B42u; // "BKNP"
+constexpr auto HELLO_INTERVAL = std::chrono::milliseconds(200);
+constexpr size_t MAX_PACKET_SIZE = 1200; // stays below any MTU
+constexpr uint32_t NO_CHECKSUM = UINT32_MAX;
+
+// both sides run the same build, the packets are raw structs like the files on disk
+struct PacketHeader
+{
+    uint32_t magic;
+    uint8_t type; // PacketType
+    uint8_t reserved[3];
+};
+
+struct StartPayload
+{
+    uint64_t seed;
+    uint8_t difficulty; // Difficulty
+    uint8_t reserved[7];
+};
+
+// followed by count PlayerInputs from firstTick on
+struct InputPayload
+{
+    uint32_t ack; // the sender has the receiver's input for every tick below this
+    uint32_t firstTick;
+    uint32_t count;
+    uint32_t checkTick; // NO_CHECKSUM until the sender has one
+    uint64_t checkHash;
+};
+
+constexpr uint32_t MAX_INPUTS =
+    (MAX_PACKET_SIZE - sizeof(PacketHeader) - sizeof(InputPayload)) / sizeof(PlayerInput);
+
+std::minstd_rand shimRandom{std::random_device{}()};
+
+void closeSocket(intptr_t handle)
+{
+#ifdef _WIN32
+    closesocket(static_cast<SOCKET>(handle));
+#else
+    ::close(static_cast<int>(handle));
+#endif
+}
+
+// non-blocking UDP socket on port (0 for any), -1 on failure
+intptr_t openSocket(uint16_t port, uint16_t &boundPort)
+{
+#ifdef _WIN32
+    static bool started = false;
+    if (!started) {
+        WSADATA data;
+        if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+            return -1;
+        started = true;
+    }
+    const SOCKET handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (handle == INVALID_SOCKET)
+        return -1;
+#else
+    const int handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (handle < 0)
+        return -1;
+#endif
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(handle, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+        closeSocket(static_cast<intptr_t>(handle));
+        return -1;
+    }
+
+#ifdef _WIN32
+    u_long nonBlocking = 1;
+    ioctlsocket(handle, FIONBIO, &nonBlocking);
+#else
+    fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK);
+#endif
+
+    socklen_t size = sizeof(address);
+    getsockname(handle, reinterpret_cast<sockaddr *>(&address), &size);
+    boundPort = ntohs(address.sin_port);
+    return static_cast<intptr_t>(handle);
+}
+
+uint64_t hashState(const std::vector<uint8_t> &state)
+{
+    // fnv-1a, only compared with the peer's
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const uint8_t byte : state) {
+        hash ^= byte;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+} // namespace
+
+bool Netplay::host(uint16_t port)
+{
+    close();
+    socketHandle = openSocket(port, localPort);
+    if (socketHandle < 0) {
+        TraceLog(LOG_WARNING, "Netplay: can't listen on port %u", port);
+        return false;
+    }
+
+    std::random_device device;
+    sessionSeed = uint64_t{device()} << 32 | device();
+    hosting = true;
+    netState = NetState::CONNECTING;
+    TraceLog(LOG_INFO, "Netplay: waiting for a player on port %u", localPort);
+    return true;
+}
+
+bool Netplay::join(const char *address)
+{
+    close();
+    const std::string text = address;
+    const size_t colon = text.rfind(':');
+    const std::string hostName = text.substr(0, colon);
+    auto port = static_cast<uint16_t>(NET_DEFAULT_PORT);
+    if (colon != std::string::npos)
+        port = static_cast<uint16_t>(std::strtoul(text.c_str() + colon + 1, nullptr, 10));
+
+    socketHandle = openSocket(0, localPort);
+    if (socketHandle < 0) {
+        TraceLog(LOG_WARNING, "Netplay: can't open a socket");
+        return false;
+    }
+
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo *result = nullptr;
+    if (getaddrinfo(hostName.c_str(), nullptr, &hints, &result) != 0 || !result) {
+        TraceLog(LOG_WARNING, "Netplay: can't resolve %s", hostName.c_str());
+        close();
+        return false;
+    }
+    peerAddress = reinterpret_cast<sockaddr_in *>(result->ai_addr)->sin_addr.s_addr;
+    peerPort = htons(port);
+    freeaddrinfo(result);
+
+    hosting = false;
+    netState = NetState::CONNECTING;
+    lastHello = {};
+    TraceLog(LOG_INFO, "Netplay: joining %s:%u", hostName.c_str(), port);
+    return true;
+}
+
+void Netplay::setShim(int delayMs, int lossPercent)
+{
+    shimDelay = std::chrono::milliseconds(std::max(delayMs, 0));
+    shimLoss = std::clamp(lossPercent, 0, 100);
+    if (delayMs > 0 || lossPercent > 0)
+        TraceLog(LOG_INFO, "Netplay: sending with %d ms delay and %d%% loss", delayMs,
+                 lossPercent);
+}
+
+void Netplay::close()
+{
+    if (socketHandle < 0)
+        return;
+
+    // straight out, the shim would never get to it
+    if (peerAddress != 0 && netState == NetState::RUNNING) {
+        packet.resize(sizeof(PacketHeader));
+        const PacketHeader header = {PACKET_MAGIC, static_cast<uint8_t>(PacketType::BYE), {}};
+        std::memcpy(packet.data(), &header, sizeof(header));
+        sendRaw(packet);
+    }
+    if (netState == NetState::RUNNING || netState == NetState::DISCONNECTED)
+        TraceLog(LOG_INFO, "Netplay: session closed after %u rollbacks", rollbacks);
+
+    closeSocket(socketHandle);
+    socketHandle = -1;
+    netState = NetState::OFF;
+    peerAddress = 0;
+    peerPort = 0;
+    delayed.clear();
+}
+
+void Netplay::poll()
+{
+    if (netState != NetState::CONNECTING && netState != NetState::RUNNING)
+        return;
+
+    receive();
+
+    const auto now = Clock::now();
+    if (netState == NetState::CONNECTING && !hosting && now - lastHello >= HELLO_INTERVAL) {
+        // until the host answers with START
+        sendPacket(PacketType::HELLO, nullptr, 0);
+        lastHello = now;
+    }
+    if (netState == NetState::RUNNING) {
+        // every frame, it doubles as the keep alive
+        sendInput();
+        if (now - lastReceived > std::chrono::duration<float>(NET_TIMEOUT_SECONDS)) {
+            TraceLog(LOG_WARNING, "Netplay: the other player stopped answering");
+            netState = NetState::DISCONNECTED;
+        }
+    }
+    flushDelayed();
+}
+
+void Netplay::setLocalInput(uint32_t tick, const PlayerInput &input)
+{
+    if (tick != localTicks)
+        return;
+    localInputs[tick % HISTORY] = input;
+    ++localTicks;
+}
+
+PlayerInput Netplay::localInput(uint32_t tick)
+{
+    return tick < localTicks ? localInputs[tick % HISTORY] : PlayerInput{};
+}
+
+PlayerInput Netplay::remoteInput(uint32_t tick)
+{
+    if (tick < remoteTicks)
+        return remoteInputs[tick % HISTORY];
+
+    // players mostly keep doing what they did, a menu only resets the target once
+    PlayerInput prediction = remoteInputs[(remoteTicks - 1) % HISTORY];
+    prediction.buttons &= ~PlayerInput::RESET_TARGET;
+    predictions[tick % HISTORY] = prediction;
+    predictedTicks = std::max(predictedTicks, tick + 1);
+    return prediction;
+}
+
+uint32_t Netplay::takeRollback()
+{
+    const uint32_t tick = std::exchange(rollbackTick, NO_ROLLBACK);
+    if (tick != NO_ROLLBACK)
+        ++rollbacks;
+    return tick;
+}
+
+void Netplay::addChecksum(uint32_t tick, const std::vector<uint8_t> &state)
+{
+    checksums[checksumCount++ % checksums.size()] = {tick, hashState(state)};
+    compareChecksum();
+}
+
+void Netplay::startSession()
+{
+    netState = NetState::RUNNING;
+    // nobody has input for the first ticks, they are empty on both sides
+    localInputs.fill({});
+    remoteInputs.fill({});
+    localTicks = NET_INPUT_DELAY;
+    remoteTicks = NET_INPUT_DELAY;
+    remoteAck = NET_INPUT_DELAY;
+    predictedTicks = 0;
+    rollbackTick = NO_ROLLBACK;
+    checksums.fill({NO_CHECKSUM, 0});
+    checksumCount = 0;
+    peerChecksum = {NO_CHECKSUM, 0};
+    rollbacks = 0;
+    desynced = false;
+    lastReceived = Clock::now();
+    TraceLog(LOG_INFO, "Netplay: session started on %s", getDifficultyName(sessionDifficulty));
+}
+
+void Netplay::receive()
+{
+    uint8_t buffer[MAX_PACKET_SIZE];
+    for (;;) {
+        sockaddr_in from = {};
+        socklen_t fromSize = sizeof(from);
+        const auto received =
+            recvfrom(socketHandle, reinterpret_cast<char *>(buffer), sizeof(buffer), 0,
+                     reinterpret_cast<sockaddr *>(&from), &fromSize);
+        // nothing left, or an error we can't do anything about but wait for the timeout
+        if (received <= 0)
+            return;
+        handlePacket(buffer, static_cast<size_t>(received), from.sin_addr.s_addr,
+                     from.sin_port);
+    }
+}
+
+void Netplay::handlePacket(const uint8_t *data, size_t size, uint32_t address, uint16_t port)
+{
+    PacketHeader header;
+    if (size < sizeof(header))
+        return;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != PACKET_MAGIC)
+        return;
+    // one peer per session
+    if (peerAddress != 0 && (address != peerAddress || port != peerPort))
+        return;
+
+    const uint8_t *payload = data + sizeof(header);
+    const size_t payloadSize = size - sizeof(header);
+    lastReceived = Clock::now();
+
+    switch (static_cast<PacketType>(header.type)) {
+        case PacketType::HELLO: {
+            if (!hosting)
+                return;
+            if (peerAddress == 0) {
+                peerAddress = address;
+                peerPort = port;
+                sessionDifficulty = currentDifficulty;
+                startSession();
+            }
+            // asked again when the START got lost
+            StartPayload start = {};
+            start.seed = sessionSeed;
+            start.difficulty = static_cast<uint8_t>(sessionDifficulty);
+            sendPacket(PacketType::START, &start, sizeof(start));
+            break;
+        }
+        case PacketType::START: {
+            StartPayload start;
+            if (hosting || netState != NetState::CONNECTING || payloadSize < sizeof(start))
+                return;
+            std::memcpy(&start, payload, sizeof(start));
+            if (start.difficulty > static_cast<uint8_t>(Difficulty::HARD))
+                return;
+            sessionSeed = start.seed;
+            sessionDifficulty = static_cast<Difficulty>(start.difficulty);
+            startSession();
+            break;
+        }
+        case PacketType::INPUT: {
+            InputPayload input;
+            if (netState != NetState::RUNNING || payloadSize < sizeof(input))
+                return;
+            std::memcpy(&input, payload, sizeof(input));
+            if (input.count > (payloadSize - sizeof(input)) / sizeof(PlayerInput))
+                return;
+
+            remoteAck = std::clamp(input.ack, remoteAck, localTicks);
+            const uint8_t *inputs = payload + sizeof(input);
+            for (uint32_t i = 0; i < input.count; ++i) {
+                const uint32_t tick = input.firstTick + i;
+                if (tick < remoteTicks)
+                    continue; // already have it
+                if (tick > remoteTicks)
+                    break; // a gap, the next packet fills it
+                PlayerInput tickInput;
+                std::memcpy(&tickInput, inputs + i * sizeof(PlayerInput), sizeof(tickInput));
+                if (tick < predictedTicks && predictions[tick % HISTORY] != tickInput)
+                    rollbackTick = std::min(rollbackTick, tick);
+                remoteInputs[tick % HISTORY] = tickInput;
+                ++remoteTicks;
+            }
+
+            if (input.checkTick != NO_CHECKSUM) {
+                peerChecksum = {input.checkTick, input.checkHash};
+                compareChecksum();
+            }
+            break;
+        }
+        case PacketType::BYE:
+            if (netState == NetState::RUNNING) {
+                TraceLog(LOG_INFO, "Netplay: the other player left");
+                netState = NetState::DISCONNECTED;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void Netplay::sendInput()
+{
+    // everything the peer hasn't acknowledged, a lost packet is made up by the next one
+    const uint32_t first = std::max(remoteAck, localTicks > HISTORY ? localTicks - HISTORY : 0);
+    const uint32_t count = std::min(localTicks - first, MAX_INPUTS);
+
+    uint8_t payload[sizeof(InputPayload) + MAX_INPUTS * sizeof(PlayerInput)];
+    InputPayload input = {remoteTicks, first, count, NO_CHECKSUM, 0};
+    if (checksumCount > 0) {
+        const Checksum &latest = checksums[(checksumCount - 1) % checksums.size()];
+        input.checkTick = latest.tick;
+        input.checkHash = latest.hash;
+    }
+    std::memcpy(payload, &input, sizeof(input));
+    for (uint32_t i = 0; i < count; ++i)
+        std::memcpy(payload + sizeof(input) + i * sizeof(PlayerInput),
+                    &localInputs[(first + i) % HISTORY], sizeof(PlayerInput));
+    sendPacket(PacketType::INPUT, payload, sizeof(input) + count * sizeof(PlayerInput));
+}
+
+void Netplay::sendPacket(PacketType type, const void *payload, size_t size)
+{
+    if (peerAddress == 0)
+        return;
+
+    // the shim loses packets before they are sent and holds the rest back
+    if (shimLoss > 0 && static_cast<int>(shimRandom() % 100) < shimLoss)
+        return;
+
+    packet.resize(sizeof(PacketHeader) + size);
+    const PacketHeader header = {PACKET_MAGIC, static_cast<uint8_t>(type), {}};
+    std::memcpy(packet.data(), &header, sizeof(header));
+    if (size > 0)
+        std::memcpy(packet.data() + sizeof(header), payload, size);
+
+    if (shimDelay.count() > 0)
+        delayed.push_back({Clock::now() + shimDelay, packet});
+    else
+        sendRaw(packet);
+}
+
+void Netplay::sendRaw(const std::vector<uint8_t> &bytes)
+{
+    sockaddr_in to = {};
+    to.sin_family = AF_INET;
+    to.sin_addr.s_addr = peerAddress;
+    to.sin_port = peerPort;
+    sendto(socketHandle, reinterpret_cast<const char *>(bytes.data()),
+           static_cast<int>(bytes.size()), 0, reinterpret_cast<sockaddr *>(&to), sizeof(to));
+}
+
+void Netplay::flushDelayed()
+{
+    // every packet has the same delay, they are due in the order they were queued
+    const auto now = Clock::now();
+    size_t sent = 0;
+    while (sent < delayed.size() && delayed[sent].sendTime <= now)
+        sendRaw(delayed[sent++].bytes);
+    delayed.erase(delayed.begin(), delayed.begin() + static_cast<std::ptrdiff_t>(sent));
+}
+
+void Netplay::compareChecksum()
+{
+    if (desynced || peerChecksum.tick == NO_CHECKSUM)
+        return;
+    for (const Checksum &checksum : checksums) {
+        if (checksum.tick == peerChecksum.tick && checksum.hash != peerChecksum.hash) {
+            TraceLog(LOG_ERROR, "Netplay: the simulations diverged before tick %u",
+                     checksum.tick);
+            desynced = true;
+        }
+    }
+}
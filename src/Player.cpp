@@ -3,13 +3,20 @@
 #include "Constants.hpp"
 #include "GlobalBounds.hpp"
 #include "Input.hpp"
+#include "Sfx.hpp"
 #include "raylib.h"
 #include "raymath.h"
 
 #include <algorithm>
 #include <cmath>
 
-Player::Player(const Texture2D &texture) : texture(texture)
+namespace {
+// the second player is told apart by its tint and a health bar above the first one
+constexpr Color PLAYER_TINTS[] = {WHITE, {255, 190, 120, 255}};
+constexpr Color HEALTH_COLORS[] = {YELLOW, ORANGE};
+} // namespace
+
+Player::Player(const Texture2D &texture, int slot) : texture(texture), slot(slot)
 {
     init();
 }
@@ -17,7 +24,7 @@ Player::Player(const Texture2D &texture) : texture(texture)
 void Player::init()
 {
     health = PLAYER_HEALTH;
-    position = {GetScreenWidth() / 2.f, GetScreenHeight() / 2.f};
+    position = {SCREEN_DRAW_X + slot * PLAYER_SIZE * 2.f, SCREEN_DRAW_Y};
     previousPosition = position;
     velocity = {0, 0};
 }
@@ -28,19 +35,22 @@ void Player::draw() const
                            static_cast<float>(texture.height)};
     const Rectangle dest = {position.x, position.y, PLAYER_SIZE, PLAYER_SIZE};
 
-    DrawTexturePro(texture, src, dest, {PLAYER_SIZE / 2.f, PLAYER_SIZE / 2.f}, 0.f, WHITE);
+    // a downed co-op player stays where it fell
+    const Color tint = PLAYER_TINTS[slot];
+    DrawTexturePro(texture, src, dest, {PLAYER_SIZE / 2.f, PLAYER_SIZE / 2.f}, 0.f,
+                   health > 0.f ? tint : Fade(tint, 0.3f));
 
     // draw health bar
     const float healthBar = health / PLAYER_HEALTH;
     constexpr float barWidth = 130.f;
     constexpr float barHeight = 15.f;
-    DrawRectangle(SCREEN_DRAW_X - barWidth / 2, GetScreenHeight() - barHeight - 10.f, barWidth,
-                  barHeight, GRAY);
-    DrawRectangle(SCREEN_DRAW_X - barWidth / 2, GetScreenHeight() - barHeight - 10.f,
-                  barWidth * healthBar, barHeight, YELLOW);
+    const float barY = SCREEN_HEIGHT - (barHeight + 10.f) * (slot + 1);
+    DrawRectangle(SCREEN_DRAW_X - barWidth / 2, barY, barWidth, barHeight, GRAY);
+    DrawRectangle(SCREEN_DRAW_X - barWidth / 2, barY, barWidth * healthBar, barHeight,
+                  HEALTH_COLORS[slot]);
 
-    DrawText(TextFormat("HP: %.0f", health), SCREEN_DRAW_X - barWidth / 2 + 5.f,
-             GetScreenHeight() - barHeight - 10.f + 2.f, 10, DARKGRAY);
+    DrawText(TextFormat("HP: %.0f", health), SCREEN_DRAW_X - barWidth / 2 + 5.f, barY + 2.f, 10,
+             DARKGRAY);
 
 #ifdef DEBUG_MODE
     // draw invisible bounds
@@ -54,14 +64,15 @@ void Player::draw() const
 #endif
 }
 
-void Player::update()
+PlayerInput Player::readInput()
 {
-    previousPosition = position;
-    Vector2 input = {0, 0};
+    PlayerInput input;
 
     if (Input::isMouseLeftButtonDown()) {
-        mouseTarget = GetMousePosition();
-        isMouseTargetSet = true;
+        const Vector2 mouse = GetMousePosition();
+        input.buttons |= PlayerInput::MOUSE;
+        input.mouseX = static_cast<int16_t>(std::lround(mouse.x));
+        input.mouseY = static_cast<int16_t>(std::lround(mouse.y));
     }
 
     // add gamepad support
@@ -70,25 +81,53 @@ void Player::update()
                                GetGamepadAxisMovement(0, GAMEPAD_AXIS_LEFT_Y)};
 
         if (Vector2LengthSqr(gamepadAxis) > 0.01f) {
-            input.x += gamepadAxis.x;
-            input.y += gamepadAxis.y;
+            input.stickX = static_cast<int8_t>(std::lround(Clamp(gamepadAxis.x, -1.f, 1.f) * 127));
+            input.stickY = static_cast<int8_t>(std::lround(Clamp(gamepadAxis.y, -1.f, 1.f) * 127));
         }
     }
 
+    if (Input::isPlayerUp())
+        input.buttons |= PlayerInput::UP;
+    if (Input::isPlayerDown())
+        input.buttons |= PlayerInput::DOWN;
+    if (Input::isPlayerLeft())
+        input.buttons |= PlayerInput::LEFT;
+    if (Input::isPlayerRight())
+        input.buttons |= PlayerInput::RIGHT;
+    return input;
+}
+
+void Player::update(const PlayerInput &playerInput, float deltaTime)
+{
+    previousPosition = position;
+    Vector2 input = {0, 0};
+
+    if (playerInput.buttons & PlayerInput::RESET_TARGET)
+        resetMouseTarget();
+
+    if (playerInput.buttons & PlayerInput::MOUSE) {
+        mouseTarget = {static_cast<float>(playerInput.mouseX),
+                       static_cast<float>(playerInput.mouseY)};
+        isMouseTargetSet = true;
+    }
+
+    input.x += playerInput.stickX / 127.f;
+    input.y += playerInput.stickY / 127.f;
+
     // update player position
-    if (Input::isPlayerUp()) {
+    if (playerInput.buttons & PlayerInput::UP) {
         input.y -= 1.f;
         resetMouseTarget();
     }
-    if (Input::isPlayerDown()) {
+    if (playerInput.buttons & PlayerInput::DOWN) {
         input.y += 1.f;
         resetMouseTarget();
     }
-    if (Input::isPlayerLeft()) {
+    if (playerInput.buttons & PlayerInput::LEFT) {
         input.x -= 1.f;
         resetMouseTarget();
     }
-    if (Input::isPlayerRight()) {
+    if (playerInput.buttons & PlayerInput::RIGHT) {
         input.x += 1.f;
         resetMouseTarget();
     }
@@ -104,8 +143,8 @@ void Player::update()
 
     if (input.x != 0.f || input.y != 0.f) {
         const float magnitude = Vector2Length(input);
-        position.x += (input.x / magnitude) * PLAYER_SPEED * GetFrameTime();
-        position.y += (input.y / magnitude) * PLAYER_SPEED * GetFrameTime();
+        position.x += (input.x / magnitude) * PLAYER_SPEED * deltaTime;
+        position.y += (input.y / magnitude) * PLAYER_SPEED * deltaTime;
     }
 
     position.x = std::clamp(position.x, movementBounds.left, movementBounds.right);
@@ -117,6 +156,7 @@ void Player::update()
 void Player::takeDamage(float damage)
 {
     health = fmax(health - damage, 0.0f);
+    Sfx::play(SfxId::PLAYER_HIT);
 
 // we are currently using GLFW instead of SDL2
 // the only backend that supports gamepad vibration is SDL2
@@ -128,8 +168,34 @@ void Player::takeDamage(float damage)
 #endif
 }
 
+void Player::save(StateWriter &writer) const
+{
+    writer.write(health);
+    writer.write(position);
+    writer.write(velocity);
+    writer.write(previousPosition);
+    writer.write(mouseTarget);
+    writer.write(isMouseTargetSet);
+}
+
+void Player::load(StateReader &reader)
+{
+    health = reader.read<float>();
+    position = reader.read<Vector2>();
+    velocity = reader.read<Vector2>();
+    previousPosition = reader.read<Vector2>();
+    mouseTarget = reader.read<Vector2>();
+    isMouseTargetSet = reader.read<bool>();
+}
+
 void Player::resetMouseTarget()
 {
     isMouseTargetSet = false;
     mouseTarget = {0, 0};
 }
+
+void Player::setMoveTarget(Vector2 target)
+{
+    mouseTarget = target;
+    isMouseTargetSet = true;
+}
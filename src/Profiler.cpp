@@ -0,0 +1,217 @@
+#include "Profiler.hpp"
+
+#include "raylib.h"
+
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+constexpr uint32_t EVENTS_PER_THREAD = 1 << 16; // ~15 zones per frame, minutes at 60 fps
+
+struct Event
+{
+    const char *name;
+    uint64_t begin;
+    uint64_t end;
+};
+
+// only the owning thread writes events, count is published with release so the
+// exporter sees every event below it fully written without taking a lock. the events are
+// allocated on the first record, so threads that never record in a capture cost nothing
+struct ThreadBuffer
+{
+    uint32_t id;
+    char name[32];
+    bool owned; // a live thread writes into it, guarded by registryMutex
+    std::unique_ptr<Event[]> events;
+    std::atomic<uint32_t> count{0};
+    std::atomic<uint32_t> dropped{0};
+};
+
+std::mutex registryMutex; // only taken when a thread registers or exits
+std::vector<std::unique_ptr<ThreadBuffer>> threadBuffers;
+
+// gives the buffer back when its thread exits, the loader threads of every restart reuse
+// the buffers of the ones before them instead of piling up new ones
+struct BufferOwner
+{
+    ThreadBuffer *buffer = nullptr;
+
+    ~BufferOwner()
+    {
+        if (!buffer)
+            return;
+        const std::lock_guard lock(registryMutex);
+        buffer->owned = false;
+    }
+};
+thread_local BufferOwner localBuffer;
+
+// a released buffer with the same name keeps its trace row. any other released one is the
+// next best, as long as renaming it doesn't relabel events of the running capture
+ThreadBuffer &acquireBuffer(const char *name)
+{
+    const std::lock_guard lock(registryMutex);
+    ThreadBuffer *reused = nullptr;
+    for (const auto &buffer : threadBuffers) {
+        if (buffer->owned || buffer->id == 0)
+            continue;
+        if (name && strcmp(buffer->name, name) == 0) {
+            reused = buffer.get();
+            break;
+        }
+        if (!reused && buffer->count.load(std::memory_order_relaxed) == 0)
+            reused = buffer.get();
+    }
+
+    if (!reused) {
+        auto buffer = std::make_unique<ThreadBuffer>();
+        buffer->id = static_cast<uint32_t>(threadBuffers.size());
+        reused = buffer.get();
+        threadBuffers.push_back(std::move(buffer));
+    }
+    if (reused->id == 0)
+        snprintf(reused->name, sizeof(reused->name), "main");
+    else if (name)
+        snprintf(reused->name, sizeof(reused->name), "%s", name);
+    else
+        snprintf(reused->name, sizeof(reused->name), "thread %u", reused->id);
+    reused->owned = true;
+    return *reused;
+}
+
+ThreadBuffer &getThreadBuffer()
+{
+    if (!localBuffer.buffer)
+        localBuffer.buffer = &acquireBuffer(nullptr);
+    return *localBuffer.buffer;
+}
+} // namespace
+
+std::atomic<bool> Profiler::capturing{false};
+std::string Profiler::outputPath{};
+uint64_t Profiler::captureStart = 0;
+uint64_t Profiler::captureEnd = 0;
+
+uint64_t Profiler::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void Profiler::start(const std::string &path, float seconds)
+{
+    if (isCapturing()) {
+        TraceLog(LOG_WARNING, "A trace is already being captured to %s", outputPath.c_str());
+        return;
+    }
+
+    {
+        const std::lock_guard lock(registryMutex);
+        for (const auto &buffer : threadBuffers) {
+            buffer->count.store(0, std::memory_order_relaxed);
+            buffer->dropped.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    outputPath = path;
+    captureStart = now();
+    captureEnd = seconds > 0.f ? captureStart + static_cast<uint64_t>(seconds * 1e9) : 0;
+    capturing.store(true, std::memory_order_release);
+
+    if (seconds > 0.f)
+        TraceLog(LOG_INFO, "Capturing a %.1f second trace to %s", seconds, outputPath.c_str());
+    else
+        TraceLog(LOG_INFO, "Capturing a trace to %s", outputPath.c_str());
+}
+
+void Profiler::endFrame()
+{
+    if (isCapturing() && captureEnd != 0 && now() >= captureEnd)
+        stop();
+}
+
+void Profiler::setThreadName(const char *name)
+{
+    if (!localBuffer.buffer) {
+        localBuffer.buffer = &acquireBuffer(name);
+        return;
+    }
+    const std::lock_guard lock(registryMutex);
+    snprintf(localBuffer.buffer->name, sizeof(ThreadBuffer::name), "%s", name);
+}
+
+void Profiler::record(const char *name, uint64_t begin, uint64_t end)
+{
+    ThreadBuffer &buffer = getThreadBuffer();
+    const uint32_t index = buffer.count.load(std::memory_order_relaxed);
+    if (index >= EVENTS_PER_THREAD) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (!buffer.events)
+        buffer.events = std::make_unique_for_overwrite<Event[]>(EVENTS_PER_THREAD);
+    buffer.events[index] = {name, begin, end};
+    buffer.count.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::stop()
+{
+    if (!capturing.exchange(false, std::memory_order_acq_rel))
+        return;
+
+    const std::filesystem::path parent = std::filesystem::path(outputPath).parent_path();
+    if (!parent.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(parent, error);
+    }
+
+    std::ofstream file(outputPath);
+    if (!file.is_open()) {
+        TraceLog(LOG_ERROR, "Failed to open trace file for writing: %s", outputPath.c_str());
+        return;
+    }
+
+    // timestamps are in microseconds relative to the capture start
+    auto micros = [](uint64_t ns) { return TextFormat("%.3f", ns / 1000.0); };
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    size_t written = 0;
+    uint32_t dropped = 0;
+
+    const std::lock_guard lock(registryMutex);
+    for (const auto &buffer : threadBuffers) {
+        const uint32_t count = buffer->count.load(std::memory_order_acquire);
+        if (count == 0)
+            continue;
+
+        file << (first ? "" : ",\n") << R"({"name":"thread_name","ph":"M","pid":1,"tid":)"
+             << buffer->id << R"(,"args":{"name":")" << buffer->name << "\"}}";
+        first = false;
+
+        for (uint32_t i = 0; i < count; ++i) {
+            const Event &event = buffer->events[i];
+            if (event.begin < captureStart)
+                continue;
+            file << ",\n{\"name\":\"" << event.name << R"(","ph":"X","pid":1,"tid":)"
+                 << buffer->id << ",\"ts\":" << micros(event.begin - captureStart)
+                 << ",\"dur\":" << micros(event.end - event.begin) << "}";
+        }
+        written += count;
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    file << "\n]}\n";
+    file.close();
+
+    if (dropped > 0)
+        TraceLog(LOG_WARNING, "Trace buffers were full, %u zones were dropped", dropped);
+    TraceLog(LOG_INFO, "Wrote %zu trace events to %s", written, outputPath.c_str());
+}
@@ -0,0 +1,92 @@
+#include "QualityGovernor.hpp"
+
+#include "Constants.hpp"
+#include "RenderTarget.hpp"
+#include "Settings.hpp"
+#include "raylib.h"
+
+#include <algorithm>
+
+QualityLevel QualityGovernor::level = QualityLevel::FULL;
+float QualityGovernor::windowSum = 0.f;
+int QualityGovernor::windowFrames = 0;
+double QualityGovernor::lastChange = 0.0;
+double QualityGovernor::lastStepUp = -1000.0;
+float QualityGovernor::upHold = QualityGovernor::UP_HOLD;
+
+namespace {
+const char *levelName(QualityLevel level)
+{
+    switch (level) {
+        case QualityLevel::FULL:
+            return "full";
+        case QualityLevel::SIMPLE_BULLETS:
+            return "simple bullets";
+        case QualityLevel::NO_BOMB_PULSE:
+            return "no bomb pulse";
+        case QualityLevel::LOW_RESOLUTION:
+            return "low resolution";
+        case QualityLevel::NO_SHAKE:
+            return "no shake";
+    }
+    return "unknown";
+}
+} // namespace
+
+void QualityGovernor::update(float frameTime)
+{
+    windowSum += frameTime;
+    if (++windowFrames < WINDOW_FRAMES)
+        return;
+
+    const float mean = windowSum / WINDOW_FRAMES;
+    windowSum = 0.f;
+    windowFrames = 0;
+
+    const float budget = frameBudget();
+    const double now = GetTime();
+
+    if (mean > budget * DOWN_RATIO && level < QualityLevel::NO_SHAKE) {
+        // the last step up did not hold, wait longer before trying again
+        if (now - lastStepUp < upHold)
+            upHold = std::min(upHold * 2.f, UP_HOLD_MAX);
+        setLevel(static_cast<QualityLevel>(static_cast<uint8_t>(level) + 1), mean, budget);
+    } else if (mean < budget * UP_RATIO && level > QualityLevel::FULL &&
+               now - lastChange >= upHold) {
+        lastStepUp = now;
+        setLevel(static_cast<QualityLevel>(static_cast<uint8_t>(level) - 1), mean, budget);
+        if (level == QualityLevel::FULL)
+            upHold = UP_HOLD;
+    }
+}
+
+float QualityGovernor::renderScale(float configured)
+{
+    return level >= QualityLevel::LOW_RESOLUTION ? std::min(configured, QUALITY_REDUCED_SCALE)
+                                                  : configured;
+}
+
+float QualityGovernor::frameBudget()
+{
+    // vsync and the fps limit both hold frames back, only time beyond that is a miss
+    int fps = DEFAULT_GAME_FPS;
+    if (Settings::config.vsync) {
+        const int refreshRate = GetMonitorRefreshRate(GetCurrentMonitor());
+        if (refreshRate > 0)
+            fps = refreshRate;
+    } else if (Settings::config.targetFPS > 0)
+        fps = Settings::config.targetFPS;
+    return 1.f / static_cast<float>(fps);
+}
+
+void QualityGovernor::setLevel(QualityLevel newLevel, float mean, float budget)
+{
+    TraceLog(LOG_INFO, "Quality: %s -> %s (mean %.2f ms, budget %.2f ms, step up hold %.0f s)",
+             levelName(level), levelName(newLevel), mean * 1000.f, budget * 1000.f, upHold);
+    level = newLevel;
+    lastChange = GetTime();
+
+    const float scale = renderScale(Settings::config.renderScale);
+    if (scale != RenderTarget::getScale())
+        RenderTarget::setScale(scale);
+}
@@ -0,0 +1,45 @@
+#include "Random.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <utility>
+
+Random::State Random::state = {0x9E3779B9u, 0x243F6A88u, 0xB7E15162u, 0x85A308D3u};
+
+void Random::seed(uint64_t seed)
+{
+    // splitmix64 spreads any seed, 0 included, over the whole state
+    for (size_t i = 0; i < state.size(); i += 2) {
+        seed += 0x9E3779B97F4A7C15ull;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z ^= z >> 31;
+        state[i] = static_cast<uint32_t>(z);
+        state[i + 1] = static_cast<uint32_t>(z >> 32);
+    }
+}
+
+int Random::value(int min, int max)
+{
+    if (min > max)
+        std::swap(min, max);
+    const uint32_t range = static_cast<uint32_t>(max) - static_cast<uint32_t>(min) + 1;
+    const uint32_t offset = range == 0 ? next() : next() % range;
+    return static_cast<int>(static_cast<uint32_t>(min) + offset);
+}
+
+uint32_t Random::next()
+{
+    const uint32_t result = std::rotl(state[1] * 5, 7) * 9;
+    const uint32_t shifted = state[1] << 9;
+
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= shifted;
+    state[3] = std::rotl(state[3], 11);
+
+    return result;
+}
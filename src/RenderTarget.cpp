@@ -0,0 +1,77 @@
+#include "RenderTarget.hpp"
+
+#include "Constants.hpp"
+#include "FrameCapture.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+RenderTexture2D RenderTarget::target{};
+float RenderTarget::scale = 1.f;
+
+void RenderTarget::init(float newScale)
+{
+    scale = std::clamp(newScale, RENDER_SCALE_MIN, RENDER_SCALE_MAX);
+    target = LoadRenderTexture(static_cast<int>(std::lround(SCREEN_WIDTH * scale)),
+                               static_cast<int>(std::lround(SCREEN_HEIGHT * scale)));
+    if (!IsRenderTextureValid(target)) {
+        TraceLog(LOG_ERROR, "Failed to create the %.2fx render target", scale);
+        return;
+    }
+    // point sampling keeps 1x and 2x sharp, anything in between needs filtering
+    SetTextureFilter(target.texture, scale == 1.f || scale == 2.f ? TEXTURE_FILTER_POINT
+                                                                  : TEXTURE_FILTER_BILINEAR);
+    TraceLog(LOG_INFO, "Render target: %dx%d (%.2fx)", target.texture.width,
+             target.texture.height, scale);
+}
+
+void RenderTarget::unload()
+{
+    if (target.id != 0)
+        UnloadRenderTexture(target);
+    target = {};
+}
+
+void RenderTarget::setScale(float newScale)
+{
+    if (target.id != 0 && newScale == scale)
+        return;
+    unload();
+    init(newScale);
+}
+
+void RenderTarget::begin()
+{
+    BeginTextureMode(target);
+    // gameplay coordinates stay the same at every scale
+    BeginMode2D({.offset = {0.f, 0.f}, .target = {0.f, 0.f}, .rotation = 0.f, .zoom = scale});
+}
+
+void RenderTarget::present()
+{
+    EndMode2D();
+    EndTextureMode();
+    FrameCapture::capture(target.texture);
+
+    // letterbox into the window keeping the aspect ratio
+    const auto windowWidth = static_cast<float>(GetScreenWidth());
+    const auto windowHeight = static_cast<float>(GetScreenHeight());
+    const float fit = std::min(windowWidth / SCREEN_WIDTH, windowHeight / SCREEN_HEIGHT);
+    const Rectangle dest = {(windowWidth - SCREEN_WIDTH * fit) / 2.f,
+                            (windowHeight - SCREEN_HEIGHT * fit) / 2.f, SCREEN_WIDTH * fit,
+                            SCREEN_HEIGHT * fit};
+
+    // mouse input is mapped back into gameplay coordinates
+    SetMouseOffset(static_cast<int>(-dest.x), static_cast<int>(-dest.y));
+    SetMouseScale(1.f / fit, 1.f / fit);
+
+    BeginDrawing();
+    ClearBackground(BLACK);
+    // render textures are stored upside down
+    DrawTexturePro(target.texture,
+                   {0.f, 0.f, static_cast<float>(target.texture.width),
+                    -static_cast<float>(target.texture.height)},
+                   dest, {0.f, 0.f}, 0.f, WHITE);
+    FrameCapture::drawIndicator();
+    EndDrawing();
+}
@@ -0,0 +1,415 @@
+#include "Replay.hpp"
+
+#include "raylib.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool ReplayRecorder::recording = false;
+ReplayHeader ReplayRecorder::header{};
+std::vector<uint8_t> ReplayRecorder::data{};
+std::vector<ReplayBlock> ReplayRecorder::blocks{};
+ReplayInputEncoder ReplayRecorder::encoder{};
+uint32_t ReplayRecorder::tickCount = 0;
+
+ReplayFile ReplayPlayback::file{};
+ReplayCursor ReplayPlayback::cursor{};
+
+namespace {
+void writeVarint(std::vector<uint8_t> &bytes, uint64_t value)
+{
+    while (value >= 0x80) {
+        bytes.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(value));
+}
+
+bool readVarint(std::span<const uint8_t> bytes, size_t &offset, uint64_t &value)
+{
+    value = 0;
+    for (unsigned shift = 0; shift < 64 && offset < bytes.size(); shift += 7) {
+        const uint8_t byte = bytes[offset++];
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+// small negative numbers stay small
+uint64_t zigzag(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+} // namespace
+
+void ReplayInputEncoder::add(uint32_t steps, PlayerInput input)
+{
+    // the target is only read while the button is held, keep it from counting as a change
+    if (!(input.buttons & PlayerInput::MOUSE)) {
+        input.mouseX = previous.mouseX;
+        input.mouseY = previous.mouseY;
+    }
+
+    if (input == previous && steps == previousSteps) {
+        ++repeat;
+        return;
+    }
+    if (repeat > 0) {
+        writeVarint(output, static_cast<uint64_t>(repeat) << 1);
+        repeat = 0;
+    }
+
+    uint32_t fields = 0;
+    if (input.buttons != previous.buttons)
+        fields |= REPLAY_FIELD_BUTTONS;
+    if (input.stickX != previous.stickX || input.stickY != previous.stickY)
+        fields |= REPLAY_FIELD_STICK;
+    if (input.mouseX != previous.mouseX || input.mouseY != previous.mouseY)
+        fields |= REPLAY_FIELD_MOUSE;
+
+    const int64_t stepDelta = static_cast<int64_t>(steps) - previousSteps;
+    writeVarint(output, zigzag(stepDelta) << 4 | fields << 1 | 1);
+    if (fields & REPLAY_FIELD_BUTTONS)
+        output.push_back(input.buttons);
+    if (fields & REPLAY_FIELD_STICK) {
+        output.push_back(static_cast<uint8_t>(input.stickX));
+        output.push_back(static_cast<uint8_t>(input.stickY));
+    }
+    if (fields & REPLAY_FIELD_MOUSE) {
+        writeVarint(output, zigzag(input.mouseX - previous.mouseX));
+        writeVarint(output, zigzag(input.mouseY - previous.mouseY));
+    }
+
+    previous = input;
+    previousSteps = steps;
+}
+
+void ReplayInputEncoder::finish()
+{
+    if (repeat > 0)
+        writeVarint(output, static_cast<uint64_t>(repeat) << 1);
+    repeat = 0;
+    previous = {};
+    previousSteps = 0;
+}
+
+bool ReplayInputDecoder::next(uint32_t &steps, PlayerInput &tick)
+{
+    if (repeat == 0) {
+        uint64_t token;
+        if (offset >= input.size() || !readVarint(input, offset, token))
+            return false;
+
+        if (!(token & 1)) {
+            repeat = static_cast<uint32_t>(token >> 1);
+            if (repeat == 0)
+                return false;
+        } else {
+            const auto fields = static_cast<uint32_t>(token >> 1 & 7);
+            previousSteps = static_cast<uint32_t>(previousSteps + unzigzag(token >> 4));
+
+            if (fields & REPLAY_FIELD_BUTTONS) {
+                if (offset + 1 > input.size())
+                    return false;
+                previous.buttons = input[offset++];
+            }
+            if (fields & REPLAY_FIELD_STICK) {
+                if (offset + 2 > input.size())
+                    return false;
+                previous.stickX = static_cast<int8_t>(input[offset++]);
+                previous.stickY = static_cast<int8_t>(input[offset++]);
+            }
+            if (fields & REPLAY_FIELD_MOUSE) {
+                uint64_t x;
+                uint64_t y;
+                if (!readVarint(input, offset, x) || !readVarint(input, offset, y))
+                    return false;
+                previous.mouseX = static_cast<int16_t>(previous.mouseX + unzigzag(x));
+                previous.mouseY = static_cast<int16_t>(previous.mouseY + unzigzag(y));
+            }
+            repeat = 1;
+        }
+    }
+
+    --repeat;
+    steps = previousSteps;
+    tick = previous;
+    return true;
+}
+
+uint32_t ReplayStepClock::next(float frameTime)
+{
+    const auto toSteps = [](float seconds) {
+        return static_cast<uint32_t>(std::max(1l, std::lround(seconds / REPLAY_STEP_SECONDS)));
+    };
+    const uint32_t frameSteps = toSteps(frameTime);
+    if (rate == 0 || frameSteps > rate + RATE_TOLERANCE || frameSteps + RATE_TOLERANCE < rate)
+        rate = frameSteps;
+
+    drift += frameTime;
+    uint32_t steps = rate;
+    if (std::fabs(drift - replayStepSeconds(steps)) > MAX_DRIFT)
+        steps = toSteps(drift);
+    drift -= replayStepSeconds(steps);
+    return steps;
+}
+
+void ReplayRecorder::begin(Difficulty difficulty, bool survival, bool hitPrediction)
+{
+    discard();
+    recording = true;
+    header.difficulty = static_cast<uint8_t>(difficulty);
+    header.survival = survival;
+    header.hitPrediction = hitPrediction;
+}
+
+bool ReplayRecorder::wantsKeyframe(float gameTime, size_t bullets)
+{
+    const ReplayBlock &last = blocks.back();
+    const float elapsed = gameTime - last.gameTime;
+    const float interval =
+        std::clamp(static_cast<float>(last.keyframeSize) / KEYFRAME_BYTES_PER_SECOND,
+                   KEYFRAME_INTERVAL, KEYFRAME_MAX_INTERVAL);
+    // a busy screen only holds the keyframe back so long, seeking needs them regularly
+    return elapsed >= interval &&
+           (bullets <= QUIET_BULLETS || elapsed >= std::min(interval * 2.f, KEYFRAME_MAX_INTERVAL));
+}
+
+void ReplayRecorder::addKeyframe(float gameTime, std::span<const uint8_t> state)
+{
+    if (!blocks.empty())
+        closeBlock();
+
+    ReplayBlock block{};
+    block.offset = sizeof(ReplayHeader) + data.size();
+    block.keyframeSize = static_cast<uint32_t>(state.size());
+    block.firstTick = tickCount;
+    block.gameTime = gameTime;
+    blocks.push_back(block);
+    data.insert(data.end(), state.begin(), state.end());
+}
+
+void ReplayRecorder::addTick(uint32_t steps, const PlayerInput &input, float gameTime)
+{
+    encoder.add(steps, input);
+    ++tickCount;
+    header.duration = gameTime;
+}
+
+void ReplayRecorder::closeBlock()
+{
+    encoder.finish();
+    ReplayBlock &block = blocks.back();
+    block.inputSize = static_cast<uint32_t>(encoder.bytes().size());
+    block.tickCount = tickCount - block.firstTick;
+    data.insert(data.end(), encoder.bytes().begin(), encoder.bytes().end());
+    encoder.bytes().clear();
+}
+
+bool ReplayRecorder::finish(const std::string &path, RunResult result)
+{
+    if (!recording || blocks.empty())
+        return false;
+    closeBlock();
+    recording = false;
+
+    header.magic = REPLAY_MAGIC;
+    header.version = REPLAY_VERSION;
+    header.headerSize = sizeof(ReplayHeader);
+    header.timestamp = static_cast<int64_t>(std::time(nullptr));
+    header.indexOffset = sizeof(ReplayHeader) + data.size();
+    header.blockCount = static_cast<uint32_t>(blocks.size());
+    header.tickCount = tickCount;
+    header.result = static_cast<uint8_t>(result);
+
+    // a crash leaves the previous replay, never half of one
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+    const std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(data.data()),
+                   static_cast<std::streamsize>(data.size()));
+        file.write(reinterpret_cast<const char *>(blocks.data()),
+                   static_cast<std::streamsize>(blocks.size() * sizeof(ReplayBlock)));
+        file.close();
+        if (!file) {
+            TraceLog(LOG_WARNING, "Failed to write replay: %s", temporaryPath.c_str());
+            std::filesystem::remove(temporaryPath, error);
+            discard();
+            return false;
+        }
+    }
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        TraceLog(LOG_WARNING, "Failed to replace replay: %s", error.message().c_str());
+        discard();
+        return false;
+    }
+
+    TraceLog(LOG_INFO, "Replay: %u ticks in %zu blocks, %zu bytes written to %s", tickCount,
+             blocks.size(), header.indexOffset + blocks.size() * sizeof(ReplayBlock),
+             path.c_str());
+    discard();
+    return true;
+}
+
+void ReplayRecorder::discard()
+{
+    // the buffers keep their capacity for the next run
+    recording = false;
+    header = {};
+    data.clear();
+    blocks.clear();
+    encoder.finish();
+    encoder.bytes().clear();
+    tickCount = 0;
+}
+
+bool ReplayFile::open(const std::string &path)
+{
+    close();
+#ifdef _WIN32
+    // no mmap, the replay is read into memory once instead
+    int fileSize = 0;
+    data = LoadFileData(path.c_str(), &fileSize);
+    size = static_cast<size_t>(fileSize);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        struct stat stats = {};
+        void *mapping = MAP_FAILED;
+        if (fstat(fd, &stats) == 0 && stats.st_size > 0)
+            mapping =
+                mmap(nullptr, static_cast<size_t>(stats.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping != MAP_FAILED) {
+            data = static_cast<unsigned char *>(mapping);
+            size = static_cast<size_t>(stats.st_size);
+        }
+    }
+#endif
+    if (!data) {
+        TraceLog(LOG_WARNING, "Failed to open replay: %s", path.c_str());
+        return false;
+    }
+
+    bool valid = size >= sizeof(ReplayHeader);
+    if (valid) {
+        std::memcpy(&info, data, sizeof(info));
+        valid = info.magic == REPLAY_MAGIC && info.version == REPLAY_VERSION &&
+                info.headerSize == sizeof(ReplayHeader) && info.blockCount > 0 &&
+                info.difficulty <= static_cast<uint8_t>(Difficulty::HARD) &&
+                info.indexOffset <= size &&
+                info.blockCount <= (size - info.indexOffset) / sizeof(ReplayBlock);
+    }
+    if (valid) {
+        blocks.resize(info.blockCount);
+        std::memcpy(blocks.data(), data + info.indexOffset, blocks.size() * sizeof(ReplayBlock));
+        valid = std::all_of(blocks.begin(), blocks.end(), [this](const ReplayBlock &block) {
+            return block.offset >= sizeof(ReplayHeader) && block.offset <= info.indexOffset &&
+                   uint64_t{block.keyframeSize} + block.inputSize <=
+                       info.indexOffset - block.offset;
+        });
+    }
+    if (!valid) {
+        TraceLog(LOG_WARNING, "Not a usable replay: %s", path.c_str());
+        close();
+        return false;
+    }
+
+    TraceLog(LOG_INFO, "Replay: opened %s, %u ticks in %u blocks", path.c_str(), info.tickCount,
+             info.blockCount);
+    return true;
+}
+
+void ReplayFile::close()
+{
+    if (!data)
+        return;
+#ifdef _WIN32
+    UnloadFileData(data);
+#else
+    munmap(data, size);
+#endif
+    data = nullptr;
+    size = 0;
+    info = {};
+    blocks.clear();
+}
+
+std::span<const uint8_t> ReplayFile::keyframe(size_t index) const
+{
+    const ReplayBlock &entry = blocks[index];
+    return {data + entry.offset, entry.keyframeSize};
+}
+
+std::span<const uint8_t> ReplayFile::input(size_t index) const
+{
+    const ReplayBlock &entry = blocks[index];
+    return {data + entry.offset + entry.keyframeSize, entry.inputSize};
+}
+
+size_t ReplayFile::blockAt(float gameTime) const
+{
+    const auto after = std::upper_bound(
+        blocks.begin(), blocks.end(), gameTime,
+        [](float time, const ReplayBlock &block) { return time < block.gameTime; });
+    return after == blocks.begin() ? 0 : static_cast<size_t>(after - blocks.begin()) - 1;
+}
+
+void ReplayCursor::seek(const ReplayFile &replay, size_t index)
+{
+    file = &replay;
+    currentBlock = index;
+    decoder = ReplayInputDecoder(file->input(currentBlock));
+}
+
+bool ReplayCursor::next(uint32_t &steps, PlayerInput &input)
+{
+    if (!file)
+        return false;
+    while (!decoder.next(steps, input)) {
+        if (currentBlock + 1 >= file->blockCount())
+            return false;
+        ++currentBlock;
+        decoder = ReplayInputDecoder(file->input(currentBlock));
+    }
+    return true;
+}
+
+bool ReplayPlayback::open(const std::string &path)
+{
+    return file.open(path);
+}
+
+void ReplayPlayback::close()
+{
+    cursor = {};
+    file.close();
+}
+
+std::span<const uint8_t> ReplayPlayback::seek(size_t block)
+{
+    cursor.seek(file, block);
+    return file.keyframe(block);
+}
@@ -0,0 +1,238 @@
+#include "RunStore.hpp"
+
+#include "Settings.hpp"
+#include "raylib.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+
+std::vector<RunRecord> RunStore::runs{};
+std::array<std::vector<uint32_t>, RunStore::BOARD_COUNT> RunStore::rankings{};
+std::array<size_t, RunStore::BOARD_COUNT> RunStore::runCounts{};
+std::thread RunStore::writer{};
+std::mutex RunStore::queueMutex{};
+std::condition_variable RunStore::queueChanged{};
+std::vector<RunRecord> RunStore::queue{};
+std::vector<RunRecord> RunStore::compaction{};
+bool RunStore::compactPending = false;
+bool RunStore::stopping = false;
+
+void RunStore::load()
+{
+    const std::string path = Settings::getConfigPath(RUNS_FILE_NAME);
+    std::error_code error;
+    const uintmax_t fileSize = std::filesystem::file_size(path, error);
+
+    size_t dropped = 0;
+    bool damaged = false;
+    if (!error && fileSize > 0) {
+        runs.resize(fileSize / sizeof(RunRecord));
+        std::ifstream file(path, std::ios::binary);
+        file.read(reinterpret_cast<char *>(runs.data()),
+                  static_cast<std::streamsize>(runs.size() * sizeof(RunRecord)));
+        const bool read = static_cast<bool>(file);
+        file.close();
+        if (read) {
+            // a partial record at the end is a write that was cut off, it goes before
+            // anything is appended behind it
+            if (fileSize % sizeof(RunRecord) != 0) {
+                std::filesystem::resize_file(path, runs.size() * sizeof(RunRecord), error);
+                damaged = true;
+            }
+            dropped = std::erase_if(runs, [](const RunRecord &run) { return !isValid(run); });
+            damaged |= dropped > 0;
+        } else {
+            // leave the file alone, a compaction would throw its runs away
+            TraceLog(LOG_WARNING, "Failed to read run history: %s", path.c_str());
+            runs.clear();
+        }
+    }
+
+    // sorting once is much cheaper than inserting tens of thousands of runs one by one
+    for (uint32_t i = 0; i < runs.size(); ++i) {
+        const size_t index =
+            board(static_cast<Difficulty>(runs[i].difficulty), static_cast<RunMode>(runs[i].mode));
+        ++runCounts[index];
+        if (isRanked(runs[i]))
+            rankings[index].push_back(i);
+    }
+    for (auto &ranking : rankings) {
+        std::stable_sort(ranking.begin(), ranking.end(),
+                         [](uint32_t a, uint32_t b) { return isBetter(runs[a], runs[b]); });
+    }
+
+    if (damaged) {
+        TraceLog(LOG_WARNING, "Run history is damaged, rewriting it without %zu bad records",
+                 dropped);
+        compaction = runs;
+        compactPending = true;
+    }
+    writer = std::thread(writeLoop);
+
+    TraceLog(LOG_INFO, "Loaded %zu runs from %s", runs.size(), path.c_str());
+}
+
+void RunStore::add(float gameTime,
+                   Difficulty difficulty,
+                   RunMode mode,
+                   RunResult result,
+                   uint32_t survivalLevel,
+                   uint32_t peakEntities)
+{
+    RunRecord run{};
+    run.magic = RUNS_MAGIC;
+    run.version = RUNS_VERSION;
+    run.size = sizeof(RunRecord);
+    run.timestamp = static_cast<int64_t>(std::time(nullptr));
+    run.gameTime = gameTime;
+    run.survivalLevel = survivalLevel;
+    run.peakEntities = peakEntities;
+    run.difficulty = static_cast<uint8_t>(difficulty);
+    run.mode = static_cast<uint8_t>(mode);
+    run.result = static_cast<uint8_t>(result);
+    run.checksum = checksum(run);
+
+    const auto index = static_cast<uint32_t>(runs.size());
+    runs.push_back(run);
+    const size_t runBoard = board(difficulty, mode);
+    ++runCounts[runBoard];
+    if (isRanked(run)) {
+        auto &ranking = rankings[runBoard];
+        // after the runs with the same time, older runs keep their place
+        const auto position = std::upper_bound(
+            ranking.begin(), ranking.end(), index,
+            [](uint32_t a, uint32_t b) { return isBetter(runs[a], runs[b]); });
+        ranking.insert(position, index);
+    }
+
+    {
+        const std::lock_guard lock(queueMutex);
+        queue.push_back(run);
+    }
+    queueChanged.notify_one();
+}
+
+void RunStore::shutdown()
+{
+    if (!writer.joinable())
+        return;
+
+    {
+        const std::lock_guard lock(queueMutex);
+        stopping = true;
+    }
+    queueChanged.notify_one();
+    writer.join();
+}
+
+size_t RunStore::board(Difficulty difficulty, RunMode mode)
+{
+    // survival is always played on the HARD rules
+    return mode == RunMode::SURVIVAL ? BOARD_COUNT - 1 : static_cast<size_t>(difficulty);
+}
+
+std::span<const uint32_t> RunStore::ranking(size_t board)
+{
+    return rankings[board];
+}
+
+uint32_t RunStore::checksum(const RunRecord &record)
+{
+    // FNV-1a over every field before the checksum
+    const auto *bytes = reinterpret_cast<const unsigned char *>(&record);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < offsetof(RunRecord, checksum); ++i) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool RunStore::isValid(const RunRecord &record)
+{
+    return record.magic == RUNS_MAGIC && record.version == RUNS_VERSION &&
+           record.size == sizeof(RunRecord) && record.checksum == checksum(record) &&
+           record.difficulty <= static_cast<uint8_t>(Difficulty::HARD) &&
+           record.mode <= static_cast<uint8_t>(RunMode::SURVIVAL);
+}
+
+bool RunStore::isRanked(const RunRecord &record)
+{
+    // a lost survival run still counts, nobody beats the boss there
+    return record.mode == static_cast<uint8_t>(RunMode::SURVIVAL) ||
+           record.result == static_cast<uint8_t>(RunResult::WIN);
+}
+
+bool RunStore::isBetter(const RunRecord &a, const RunRecord &b)
+{
+    if (a.mode == static_cast<uint8_t>(RunMode::SURVIVAL))
+        return a.gameTime > b.gameTime;
+    return a.gameTime < b.gameTime;
+}
+
+void RunStore::writeLoop()
+{
+    const std::string path = Settings::getConfigPath(RUNS_FILE_NAME);
+    std::vector<RunRecord> writing;
+
+    for (;;) {
+        bool compactNow;
+        bool stop;
+        {
+            std::unique_lock lock(queueMutex);
+            queueChanged.wait(lock, [] { return stopping || compactPending || !queue.empty(); });
+            writing.swap(queue);
+            compactNow = compactPending;
+            compactPending = false;
+            stop = stopping;
+        }
+
+        // the compacted file holds the runs loaded before anything was queued
+        if (compactNow)
+            compact(path);
+
+        if (!writing.empty()) {
+            std::error_code error;
+            std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+            std::ofstream file(path, std::ios::binary | std::ios::app);
+            file.write(reinterpret_cast<const char *>(writing.data()),
+                       static_cast<std::streamsize>(writing.size() * sizeof(RunRecord)));
+            if (!file)
+                TraceLog(LOG_WARNING, "Failed to write %zu runs to %s", writing.size(),
+                         path.c_str());
+            writing.clear();
+        }
+
+        if (stop)
+            return;
+    }
+}
+
+void RunStore::compact(const std::string &path)
+{
+    // a crash leaves either the old file or the new one, never half of each
+    const std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(compaction.data()),
+                   static_cast<std::streamsize>(compaction.size() * sizeof(RunRecord)));
+        file.close();
+        if (!file) {
+            TraceLog(LOG_WARNING, "Failed to compact run history: %s", temporaryPath.c_str());
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        TraceLog(LOG_WARNING, "Failed to replace run history: %s", error.message().c_str());
+        return;
+    }
+    TraceLog(LOG_INFO, "Compacted run history to %zu runs", compaction.size());
+    compaction.clear();
+    compaction.shrink_to_fit();
+}
@@ -0,0 +1,282 @@
+#include "SamplingProfiler.hpp"
+
+#ifdef SAMPLING_PROFILER
+
+#include "raylib.h"
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <dlfcn.h>
+#include <link.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+// older glibc headers only expose the union member
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+namespace {
+constexpr uint32_t MAX_DEPTH = 48;
+constexpr uint32_t RING_SIZE = 1024; // drained every frame, enough for a few hundred ms at 1 kHz
+
+struct Sample
+{
+    uint32_t depth;
+    uintptr_t pcs[MAX_DEPTH]; // leaf first, the rest are return addresses
+};
+
+struct StackHash
+{
+    size_t operator()(const std::vector<uintptr_t> &stack) const
+    {
+        size_t hash = 14695981039346656037ull; // FNV-1a over the addresses
+        for (const uintptr_t pc : stack)
+            hash = (hash ^ pc) * 1099511628211ull;
+        return hash;
+    }
+};
+
+// the signal handler is the only writer of the ring and runs on the main thread, which
+// is also the only reader, so lock-free atomics are all the synchronization needed
+Sample ring[RING_SIZE];
+std::atomic<uint32_t> ringHead{0};
+std::atomic<uint32_t> ringTail{0};
+std::atomic<uint32_t> lostSamples{0};
+uintptr_t stackLow = 0;
+uintptr_t stackHigh = 0;
+
+timer_t timer{};
+bool timerCreated = false;
+bool running = false;
+long intervalNs = 0;
+std::string outputPath;
+std::unordered_map<std::vector<uintptr_t>, uint32_t, StackHash> stacks;
+uint64_t totalSamples = 0;
+
+void readRegisters(const ucontext_t *context, uintptr_t &pc, uintptr_t &fp)
+{
+#if defined(__x86_64__)
+    pc = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_RIP]);
+    fp = static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_RBP]);
+#elif defined(__aarch64__)
+    pc = static_cast<uintptr_t>(context->uc_mcontext.pc);
+    fp = static_cast<uintptr_t>(context->uc_mcontext.regs[29]);
+#else
+#error "The sampling profiler supports x86_64 and aarch64 only"
+#endif
+}
+
+// async-signal-safe: no allocation, no locks, only reads inside the main thread's stack
+void onSample(int, siginfo_t *, void *context)
+{
+    const int savedErrno = errno;
+    const uint32_t head = ringHead.load(std::memory_order_relaxed);
+    if (head - ringTail.load(std::memory_order_acquire) >= RING_SIZE) {
+        lostSamples.fetch_add(1, std::memory_order_relaxed);
+        errno = savedErrno;
+        return;
+    }
+
+    Sample &sample = ring[head % RING_SIZE];
+    uintptr_t pc = 0;
+    uintptr_t fp = 0;
+    readRegisters(static_cast<const ucontext_t *>(context), pc, fp);
+
+    uint32_t depth = 0;
+    sample.pcs[depth++] = pc;
+    // every frame starts with {previous frame pointer, return address}, the walk stops
+    // at the first frame built without a frame pointer (system libraries mostly)
+    while (depth < MAX_DEPTH && fp >= stackLow && fp + 2 * sizeof(uintptr_t) <= stackHigh &&
+           fp % sizeof(uintptr_t) == 0) {
+        const auto *frame = reinterpret_cast<const uintptr_t *>(fp);
+        if (frame[1] == 0)
+            break;
+        sample.pcs[depth++] = frame[1];
+        if (frame[0] <= fp)
+            break; // stacks grow down, callers must be higher up
+        fp = frame[0];
+    }
+    sample.depth = depth;
+
+    ringHead.store(head + 1, std::memory_order_release);
+    errno = savedErrno;
+}
+
+// frames inside the game binary are written as link time addresses for offline
+// symbolization, shared libraries are resolved right away through their exports
+class FrameNames
+{
+public:
+    FrameNames()
+    {
+        Dl_info info{};
+        if (dladdr(reinterpret_cast<void *>(&onSample), &info) && info.dli_fbase) {
+            executableBase = reinterpret_cast<uintptr_t>(info.dli_fbase);
+            const auto *header = static_cast<const ElfW(Ehdr) *>(info.dli_fbase);
+            isPie = header->e_type == ET_DYN;
+        }
+    }
+
+    const std::string &get(uintptr_t pc)
+    {
+        auto [it, inserted] = names.try_emplace(pc);
+        if (inserted)
+            it->second = resolve(pc);
+        return it->second;
+    }
+
+private:
+    std::unordered_map<uintptr_t, std::string> names;
+    uintptr_t executableBase = 0;
+    bool isPie = true;
+
+    std::string resolve(uintptr_t pc) const
+    {
+        Dl_info info{};
+        if (!dladdr(reinterpret_cast<void *>(pc), &info) || !info.dli_fbase)
+            return "[unknown]";
+
+        const auto base = reinterpret_cast<uintptr_t>(info.dli_fbase);
+        if (base == executableBase)
+            return TextFormat("0x%zx", isPie ? pc - base : pc);
+
+        std::string_view module = info.dli_fname ? info.dli_fname : "[unknown]";
+        if (const size_t slash = module.rfind('/'); slash != std::string_view::npos)
+            module.remove_prefix(slash + 1);
+
+        std::string name(module);
+        if (info.dli_sname)
+            name.append("`").append(info.dli_sname);
+        else
+            name.append(TextFormat("`+0x%zx", pc - base));
+        return name;
+    }
+};
+} // namespace
+
+bool SamplingProfiler::init(const std::string &path, int hz)
+{
+    if (timerCreated)
+        return true;
+    if (hz < 1 || hz > 10000) {
+        TraceLog(LOG_WARNING, "Sampling rate %d Hz is out of range, using %d Hz", hz,
+                 PROFILE_DEFAULT_HZ);
+        hz = PROFILE_DEFAULT_HZ;
+    }
+
+    pthread_attr_t attr;
+    if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+        void *stackAddress = nullptr;
+        size_t stackSize = 0;
+        pthread_attr_getstack(&attr, &stackAddress, &stackSize);
+        pthread_attr_destroy(&attr);
+        stackLow = reinterpret_cast<uintptr_t>(stackAddress);
+        stackHigh = stackLow + stackSize;
+    }
+
+    struct sigaction action{};
+    action.sa_sigaction = onSample;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, nullptr) != 0) {
+        TraceLog(LOG_ERROR, "Failed to install the SIGPROF handler");
+        return false;
+    }
+
+    // the main thread's cpu clock, waiting for vsync or in the menus costs no samples
+    clockid_t clock{};
+    if (pthread_getcpuclockid(pthread_self(), &clock) != 0)
+        clock = CLOCK_MONOTONIC;
+
+    sigevent event{};
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGPROF;
+    event.sigev_notify_thread_id = static_cast<pid_t>(syscall(SYS_gettid));
+    if (timer_create(clock, &event, &timer) != 0) {
+        TraceLog(LOG_ERROR, "Failed to create the sampling timer");
+        signal(SIGPROF, SIG_DFL);
+        return false;
+    }
+
+    timerCreated = true;
+    intervalNs = 1000000000L / hz;
+    outputPath = path;
+    TraceLog(LOG_INFO, "Sampling profiler ready at %d Hz, writing to %s", hz, outputPath.c_str());
+    return true;
+}
+
+void SamplingProfiler::setActive(bool active)
+{
+    if (!timerCreated || active == running)
+        return;
+
+    itimerspec spec{};
+    if (active)
+        spec.it_value = spec.it_interval = {0, intervalNs};
+    timer_settime(timer, 0, &spec, nullptr);
+    running = active;
+}
+
+void SamplingProfiler::collect()
+{
+    const uint32_t head = ringHead.load(std::memory_order_acquire);
+    uint32_t tail = ringTail.load(std::memory_order_relaxed);
+    for (; tail != head; ++tail) {
+        const Sample &sample = ring[tail % RING_SIZE];
+        ++stacks[std::vector<uintptr_t>(sample.pcs, sample.pcs + sample.depth)];
+        ++totalSamples;
+        // the slot may only be reused by the handler once it has been copied
+        ringTail.store(tail + 1, std::memory_order_release);
+    }
+}
+
+void SamplingProfiler::shutdown()
+{
+    if (!timerCreated)
+        return;
+
+    setActive(false);
+    timer_delete(timer);
+    signal(SIGPROF, SIG_DFL);
+    timerCreated = false;
+    collect();
+
+    // folded stacks: root first, one "frame;frame;frame count" line per unique stack
+    FrameNames frameNames;
+    std::unordered_map<std::string, uint64_t> folded;
+    for (const auto &[stack, count] : stacks) {
+        std::string line;
+        for (size_t i = stack.size(); i-- > 0;) {
+            // return addresses point after the call, step back into the calling instruction
+            line.append(frameNames.get(i == 0 ? stack[i] : stack[i] - 1));
+            if (i != 0)
+                line.push_back(';');
+        }
+        folded[line] += count;
+    }
+
+    std::ofstream file(outputPath);
+    if (!file.is_open()) {
+        TraceLog(LOG_ERROR, "Failed to open profile file for writing: %s", outputPath.c_str());
+        return;
+    }
+    for (const auto &[line, count] : folded)
+        file << line << ' ' << count << '\n';
+    file.close();
+
+    TraceLog(LOG_INFO, "Wrote %llu samples (%zu stacks, %u lost) to %s",
+             static_cast<unsigned long long>(totalSamples), folded.size(),
+             lostSamples.load(std::memory_order_relaxed), outputPath.c_str());
+}
+
+#endif // SAMPLING_PROFILER
@@ -0,0 +1,104 @@
+#include "Script.hpp"
+
+#include "raylib.h"
+
+#include <new>
+#include <numeric>
+
+alignas(std::max_align_t) unsigned char ScriptScheduler::frames[FRAME_COUNT][FRAME_SIZE];
+std::vector<uint8_t> ScriptScheduler::freeFrames = [] {
+    std::vector<uint8_t> indices(FRAME_COUNT);
+    std::iota(indices.rbegin(), indices.rend(), 0); // hand out frame 0 first
+    return indices;
+}();
+std::vector<Script> ScriptScheduler::scripts{};
+std::vector<std::coroutine_handle<>> ScriptScheduler::ticking{};
+std::vector<std::coroutine_handle<>> ScriptScheduler::resuming{};
+std::vector<ScriptScheduler::Waiter> ScriptScheduler::waiting{};
+
+void *Script::promise_type::operator new(size_t size)
+{
+    return ScriptScheduler::allocateFrame(size);
+}
+
+void Script::promise_type::operator delete(void *ptr, size_t size)
+{
+    ScriptScheduler::freeFrame(ptr, size);
+}
+
+ScriptScheduler::Handle ScriptScheduler::spawn(Script script)
+{
+    // the queues never hold more handles than there are scripts
+    if (scripts.capacity() == 0) {
+        scripts.reserve(FRAME_COUNT);
+        ticking.reserve(FRAME_COUNT);
+        resuming.reserve(FRAME_COUNT);
+        waiting.reserve(FRAME_COUNT);
+    }
+
+    const Handle handle = script.handle;
+    ticking.push_back(handle);
+    scripts.push_back(std::move(script));
+    return handle;
+}
+
+void ScriptScheduler::update()
+{
+    // collect everything due first, resumed scripts may queue themselves again. expired
+    // delays were already queued by the wheel
+    resuming.clear();
+    resuming.swap(ticking);
+
+    size_t kept = 0;
+    for (const Waiter &waiter : waiting) {
+        if (waiter.check(waiter.awaiter))
+            resuming.push_back(waiter.handle);
+        else
+            waiting[kept++] = waiter;
+    }
+    waiting.resize(kept);
+
+    for (const std::coroutine_handle<> handle : resuming)
+        resume(handle);
+    resuming.clear();
+}
+
+void ScriptScheduler::clear()
+{
+    ticking.clear();
+    resuming.clear();
+    waiting.clear();
+    scripts.clear(); // destroys the frames
+}
+
+void *ScriptScheduler::allocateFrame(size_t size)
+{
+    if (size <= FRAME_SIZE && !freeFrames.empty()) {
+        const uint8_t index = freeFrames.back();
+        freeFrames.pop_back();
+        return frames[index];
+    }
+
+    TraceLog(LOG_WARNING, "Script: %zu byte frame does not fit the pool, using the heap", size);
+    return ::operator new(size);
+}
+
+void ScriptScheduler::freeFrame(void *ptr, size_t size)
+{
+    const auto *bytes = static_cast<unsigned char *>(ptr);
+    if (bytes >= frames[0] && bytes < frames[0] + sizeof(frames)) {
+        freeFrames.push_back(static_cast<uint8_t>((bytes - frames[0]) / FRAME_SIZE));
+        return;
+    }
+    ::operator delete(ptr, size);
+}
+
+void ScriptScheduler::resume(std::coroutine_handle<> handle)
+{
+    handle.resume();
+    if (handle.done()) {
+        std::erase_if(scripts, [handle](const Script &script) {
+            return script.handle.address() == handle.address();
+        });
+    }
+}
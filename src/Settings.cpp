@@ -4,12 +4,16 @@
 #include "Game.hpp"
 #include "Input.hpp"
 #include "MainMenu.hpp"
+#include "QualityGovernor.hpp"
+#include "RenderTarget.hpp"
+#include "Sfx.hpp"
 #include "raylib.h"
 
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <string>
+#include <string_view>
 
 extern Game game;
 
@@ -22,7 +26,7 @@ SettingsState Settings::state = SettingsState::MAIN_MENU;
 
 void Settings::init()
 {
-    load();
+    // the settings were already loaded by Game::init before the window was created
     applySettings(true);
 }
 
@@ -30,30 +34,38 @@ void Settings::reset()
 {
     tempConfig.vsync = true;
     tempConfig.targetFPS = DEFAULT_GAME_FPS;
+    tempConfig.renderScale = 1.0f;
     tempConfig.musicVolume = 1.0f;
+    tempConfig.sfxVolume = 1.0f;
     tempConfig.bgMusicIndex = 0;
     tempConfig.discordRPC = true;
     tempConfig.shakeScreen = true;
+    tempConfig.hitPrediction = false;
     config = tempConfig; // set default config
     save();
 }
 
-std::string Settings::getSettingsPath()
+std::string Settings::getConfigPath(const char *fileName)
 {
 #ifdef _WIN32
     const char *envVar = "APPDATA";
-    const char *suffix = "/BombKurdistan/settings.cfg";
+    const char *suffix = "/BombKurdistan/";
 #else
     const char *envVar = "HOME";
-    const char *suffix = "/.config/BombKurdistan/settings.cfg";
+    const char *suffix = "/.config/BombKurdistan/";
 #endif
 
     if (auto path = getenv(envVar))
-        return std::string(path) + suffix;
+        return std::string(path) + suffix + fileName;
 
     TraceLog(LOG_WARNING, "Could not find %s environment variable. Using current directory.",
              envVar);
-    return "settings.cfg";
+    return fileName;
+}
+
+std::string Settings::getSettingsPath()
+{
+    return getConfigPath("settings.cfg");
 }
 
 void Settings::load()
@@ -70,8 +82,9 @@ void Settings::load()
     while (std::getline(file, line)) {
         const size_t pos = line.find('=');
         if (pos != std::string::npos) {
-            std::string key = line.substr(0, pos);
-            std::string value = line.substr(pos + 1);
+            // views into the line, no substring copies
+            const std::string_view key(line.data(), pos);
+            const std::string_view value(line.data() + pos + 1, line.size() - pos - 1);
 
             tempConfig.fromKey(key, value);
             tempConfig.healthCheck(); // validate settings
@@ -103,8 +116,8 @@ void Settings::applySettings(bool isInit)
         return;
     }
 
-    // DiscordRPC
-    if (tempConfig.discordRPC != config.discordRPC) {
+    // DiscordRPC, Game::init connects in the background on startup
+    if (!isInit && tempConfig.discordRPC != config.discordRPC) {
         if (tempConfig.discordRPC)
             game.connectDiscord();
         else
@@ -129,12 +142,20 @@ void Settings::applySettings(bool isInit)
         SetMusicVolume(*game.getBGMusic(), tempConfig.musicVolume);
     }
 
+    if (isInit || tempConfig.sfxVolume != config.sfxVolume)
+        Sfx::setVolume(tempConfig.sfxVolume);
+
     if (tempConfig.bgMusicIndex != config.bgMusicIndex) {
         StopMusicStream(*game.getBGMusic());
         game.setBGMusic(&game.bgMusics[tempConfig.bgMusicIndex]);
         PlayMusicStream(*game.getBGMusic());
     }
 
+    // the quality governor may be holding the scale down
+    if (const float scale = QualityGovernor::renderScale(tempConfig.renderScale);
+        scale != RenderTarget::getScale())
+        RenderTarget::setScale(scale);
+
     // TODO: add fullscreen
     config = tempConfig; // apply temporary config to the main config
 }
@@ -271,22 +292,26 @@ void Settings::drawVideoSettings()
 
     drawToggleOption("Tam Ekran", tempConfig.fullscreen, 2, SCREEN_DRAW_Y + TEXT_HEIGHT * 2);
 
+    Game::drawTextCombined(SCREEN_DRAW_X, SCREEN_DRAW_Y + TEXT_HEIGHT * 3, 20,
+                           {{"Cozunurluk Olcegi", selectedOption == 3 ? YELLOW : GRAY},
+                            {TextFormat("%gx", tempConfig.renderScale), WHITE}});
+
     if (tempConfig.fullscreen) {
         // warn user the feature is not implemented yet
         Game::drawTextCenter("Tam ekran modu henuz yapim asamasinda!!", SCREEN_DRAW_X,
-                             SCREEN_DRAW_Y + TEXT_HEIGHT * 3, 20, RED);
+                             SCREEN_DRAW_Y + TEXT_HEIGHT * 4, 20, RED);
     }
 
     Game::drawTextCenter("AYARLARI UYGULA", SCREEN_DRAW_X, SCREEN_HEIGHT - TEXT_HEIGHT * 5, 20,
-                         (selectedOption == 3) ? GREEN : DARKGREEN);
+                         (selectedOption == 4) ? GREEN : DARKGREEN);
 }
 
 void Settings::handleVideoSettingsInput()
 {
     if (Input::isArrowUp())
-        selectedOption = (selectedOption - 1 + 4) % 4;
+        selectedOption = (selectedOption - 1 + 5) % 5;
     if (Input::isArrowDown())
-        selectedOption = (selectedOption + 1) % 4;
+        selectedOption = (selectedOption + 1) % 5;
 
     if (Input::isEnterOrSpace() || Input::isArrowLeft() || Input::isArrowRight()) {
         switch (selectedOption) {
@@ -307,7 +332,19 @@ void Settings::handleVideoSettingsInput()
             case 2: // Tam Ekran
                 tempConfig.fullscreen = !tempConfig.fullscreen;
                 break;
-            case 3: // Uygula
+            case 3: { // Cozunurluk Olcegi
+                constexpr float scales[] = {0.5f, 0.75f, 1.f, 1.5f, 2.f};
+                constexpr int count = std::size(scales);
+                int index = 2;
+                for (int i = 0; i < count; ++i) {
+                    if (scales[i] == tempConfig.renderScale)
+                        index = i;
+                }
+                index = Input::isArrowLeft() ? (index - 1 + count) % count : (index + 1) % count;
+                tempConfig.renderScale = scales[index];
+                break;
+            }
+            case 4: // Uygula
                 applySettings();
                 save();
                 state = SettingsState::MAIN_MENU;
@@ -329,22 +366,26 @@ void Settings::drawAudioSettings()
                             {TextFormat("%.0f%%", tempConfig.musicVolume * 100), WHITE}});
 
     Game::drawTextCombined(SCREEN_DRAW_X, SCREEN_DRAW_Y + TEXT_HEIGHT * 2, 20,
-                           {{"Arka Plan Muzigi", (selectedOption == 1) ? YELLOW : GRAY},
+                           {{"Efekt Ses Seviyesi", (selectedOption == 1) ? YELLOW : GRAY},
+                            {TextFormat("%.0f%%", tempConfig.sfxVolume * 100), WHITE}});
+
+    Game::drawTextCombined(SCREEN_DRAW_X, SCREEN_DRAW_Y + TEXT_HEIGHT * 3, 20,
+                           {{"Arka Plan Muzigi", (selectedOption == 2) ? YELLOW : GRAY},
                             {tempConfig.bgMusicIndex == 0   ? "Varsayilan"
                              : tempConfig.bgMusicIndex == 1 ? "Funk (By Furkan)"
                                                             : "Bilinmiyor",
                              WHITE}});
 
     Game::drawTextCenter("AYARLARI UYGULA", SCREEN_DRAW_X, SCREEN_HEIGHT - TEXT_HEIGHT * 5, 20,
-                         (selectedOption == 2) ? GREEN : DARKGREEN);
+                         (selectedOption == 3) ? GREEN : DARKGREEN);
 }
 
 void Settings::handleAudioSettingsInput()
 {
     if (Input::isArrowUp())
-        selectedOption = (selectedOption - 1 + 3) % 3;
+        selectedOption = (selectedOption - 1 + 4) % 4;
     if (Input::isArrowDown())
-        selectedOption = (selectedOption + 1) % 3;
+        selectedOption = (selectedOption + 1) % 4;
 
     if (Input::isEnterOrSpace() || Input::isArrowLeft() || Input::isArrowRight()) {
         switch (selectedOption) {
@@ -354,7 +395,13 @@ void Settings::handleAudioSettingsInput()
                 if (Input::isArrowRight())
                     tempConfig.musicVolume = std::min(1.0f, tempConfig.musicVolume + 0.1f);
                 break;
-            case 1: // Arka Plan Muzigi
+            case 1: // Efekt Ses Seviyesi
+                if (Input::isArrowLeft())
+                    tempConfig.sfxVolume = std::max(0.0f, tempConfig.sfxVolume - 0.1f);
+                if (Input::isArrowRight())
+                    tempConfig.sfxVolume = std::min(1.0f, tempConfig.sfxVolume + 0.1f);
+                break;
+            case 2: // Arka Plan Muzigi
             {
                 int musicSize = static_cast<int>(game.bgMusics.size()) - 1;
                 if (Input::isArrowLeft())
@@ -364,7 +411,7 @@ void Settings::handleAudioSettingsInput()
                     tempConfig.bgMusicIndex =
                         (tempConfig.bgMusicIndex >= musicSize) ? 0 : tempConfig.bgMusicIndex + 1;
             } break;
-            case 2: // Uygula
+            case 3: // Uygula
                 applySettings();
                 save();
                 state = SettingsState::MAIN_MENU;
@@ -393,16 +440,21 @@ void Settings::drawOtherSettings()
     drawToggleOption("Ekran Sarsintisi", tempConfig.shakeScreen, 1,
                      SCREEN_DRAW_Y + TEXT_HEIGHT * 2);
 
+    drawToggleOption("Isabet Tahmini", tempConfig.hitPrediction, 2,
+                     SCREEN_DRAW_Y + TEXT_HEIGHT * 3);
+    Game::drawTextCenter("Yeni oyunda gecerli olur", SCREEN_DRAW_X, SCREEN_DRAW_Y + TEXT_HEIGHT * 4,
+                         19, GRAY);
+
     Game::drawTextCenter("AYARLARI UYGULA", SCREEN_DRAW_X, SCREEN_HEIGHT - TEXT_HEIGHT * 5, 20,
-                         (selectedOption == 2) ? GREEN : DARKGREEN);
+                         (selectedOption == 3) ? GREEN : DARKGREEN);
 }
 
 void Settings::handleOtherSettingsInput()
 {
     if (Input::isArrowUp())
-        selectedOption = (selectedOption - 1 + 3) % 3;
+        selectedOption = (selectedOption - 1 + 4) % 4;
     if (Input::isArrowDown())
-        selectedOption = (selectedOption + 1) % 3;
+        selectedOption = (selectedOption + 1) % 4;
 
     if (Input::isEnterOrSpace() || Input::isArrowLeft() || Input::isArrowRight()) {
         switch (selectedOption) {
@@ -412,7 +464,10 @@ void Settings::handleOtherSettingsInput()
             case 1: // Ekran Sarsintisi
                 tempConfig.shakeScreen = !tempConfig.shakeScreen;
                 break;
-            case 2: // Uygula
+            case 2: // Isabet Tahmini
+                tempConfig.hitPrediction = !tempConfig.hitPrediction;
+                break;
+            case 3: // Uygula
                 applySettings();
                 save();
                 state = SettingsState::MAIN_MENU;
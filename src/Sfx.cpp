@@ -0,0 +1,221 @@
+#include "Sfx.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+std::array<Sound, Sfx::SFX_COUNT> Sfx::samples{};
+std::array<Sfx::Voice, Sfx::VOICE_COUNT> Sfx::voices{};
+std::array<uint16_t, Sfx::SFX_COUNT> Sfx::requests{};
+std::array<double, Sfx::SFX_COUNT> Sfx::lastStart{};
+uint64_t Sfx::frame = 0;
+uint32_t Sfx::noiseState = 0x9E3779B9u;
+float Sfx::volume = 1.f;
+bool Sfx::loaded = false;
+bool Sfx::muted = false;
+
+namespace {
+constexpr int SAMPLE_RATE = 22050;
+constexpr float TWO_PI = 2.f * std::numbers::pi_v<float>;
+
+struct Effect
+{
+    uint8_t priority; // higher steals lower
+    float cooldown;   // seconds before the same effect may start again
+    uint8_t maxVoices;
+};
+
+// indexed by SfxId
+constexpr Effect EFFECTS[] = {
+    {.priority = 0, .cooldown = 0.06f, .maxVoices = 3}, // PLAYER_HIT, comes in bursts
+    {.priority = 1, .cooldown = 0.f, .maxVoices = 2},   // BOMB_PICKUP
+    {.priority = 2, .cooldown = 0.f, .maxVoices = 2},   // BOSS_HIT
+};
+static_assert(std::size(EFFECTS) == static_cast<size_t>(SfxId::COUNT));
+} // namespace
+
+void Sfx::init()
+{
+    if (loaded)
+        return;
+
+    std::vector<int16_t> pcm;
+    for (size_t i = 0; i < SFX_COUNT; ++i) {
+        synthesise(static_cast<SfxId>(i), pcm);
+        const Wave wave = {.frameCount = static_cast<unsigned int>(pcm.size()),
+                           .sampleRate = SAMPLE_RATE,
+                           .sampleSize = 16,
+                           .channels = 1,
+                           .data = pcm.data()};
+        samples[i] = LoadSoundFromWave(wave); // copies the samples
+    }
+
+    // aliases share the sample buffers, only the playback state is per voice
+    for (Voice &voice : voices) {
+        for (size_t i = 0; i < SFX_COUNT; ++i)
+            voice.aliases[i] = LoadSoundAlias(samples[i]);
+        voice.playing = SfxId::COUNT;
+        voice.startedFrame = 0;
+    }
+
+    loaded = true;
+    TraceLog(LOG_INFO, "Sfx: %zu effects, %zu voices", SFX_COUNT, VOICE_COUNT);
+}
+
+void Sfx::unload()
+{
+    if (!loaded)
+        return;
+
+    for (Voice &voice : voices) {
+        for (Sound &alias : voice.aliases)
+            UnloadSoundAlias(alias);
+    }
+    for (Sound &sample : samples)
+        UnloadSound(sample);
+    loaded = false;
+}
+
+void Sfx::setVolume(float newVolume)
+{
+    volume = std::clamp(newVolume, 0.f, 1.f);
+}
+
+void Sfx::flush()
+{
+    ++frame;
+    const double now = GetTime();
+
+    for (size_t i = 0; i < SFX_COUNT; ++i) {
+        const uint16_t count = requests[i];
+        requests[i] = 0;
+        if (count == 0 || !loaded || volume <= 0.f)
+            continue;
+        if (now - lastStart[i] < EFFECTS[i].cooldown)
+            continue; // dropped, the previous one is still at its loudest
+
+        const auto id = static_cast<SfxId>(i);
+        Voice *voice = pickVoice(id);
+        if (!voice)
+            continue;
+
+        if (isPlaying(*voice))
+            StopSound(voice->aliases[static_cast<size_t>(voice->playing)]);
+
+        // several hits in one frame play louder instead of more often
+        const float gain = std::min(1.f, 0.7f + 0.1f * static_cast<float>(count - 1));
+        Sound &alias = voice->aliases[i];
+        SetSoundVolume(alias, volume * gain);
+        SetSoundPitch(alias, 1.f + noise() * 0.06f); // repeated hits don't sound identical
+        PlaySound(alias);
+
+        voice->playing = id;
+        voice->startedFrame = frame;
+        lastStart[i] = now;
+    }
+}
+
+Sfx::Voice *Sfx::pickVoice(SfxId id)
+{
+    const Effect &effect = EFFECTS[static_cast<size_t>(id)];
+
+    // an effect over its voice limit restarts its own oldest voice
+    Voice *oldestSame = nullptr;
+    uint8_t sameCount = 0;
+    Voice *idle = nullptr;
+    Voice *victim = nullptr;
+    for (Voice &voice : voices) {
+        if (!isPlaying(voice)) {
+            if (!idle)
+                idle = &voice;
+            continue;
+        }
+        if (voice.playing == id) {
+            ++sameCount;
+            if (!oldestSame || voice.startedFrame < oldestSame->startedFrame)
+                oldestSame = &voice;
+        }
+
+        const uint8_t priority = EFFECTS[static_cast<size_t>(voice.playing)].priority;
+        if (!victim || priority < EFFECTS[static_cast<size_t>(victim->playing)].priority ||
+            (priority == EFFECTS[static_cast<size_t>(victim->playing)].priority &&
+             voice.startedFrame < victim->startedFrame))
+            victim = &voice;
+    }
+
+    if (sameCount >= effect.maxVoices)
+        return oldestSame;
+    if (idle)
+        return idle;
+    if (victim && EFFECTS[static_cast<size_t>(victim->playing)].priority <= effect.priority)
+        return victim;
+    return nullptr; // everything playing is more important
+}
+
+bool Sfx::isPlaying(const Voice &voice)
+{
+    return voice.playing != SfxId::COUNT &&
+           IsSoundPlaying(voice.aliases[static_cast<size_t>(voice.playing)]);
+}
+
+float Sfx::noise()
+{
+    // own xorshift, Random belongs to the simulation and must not be disturbed
+    noiseState ^= noiseState << 13;
+    noiseState ^= noiseState >> 17;
+    noiseState ^= noiseState << 5;
+    return static_cast<float>(noiseState) / 2147483648.f - 1.f;
+}
+
+void Sfx::synthesise(SfxId id, std::vector<int16_t> &pcm)
+{
+    float duration = 0.f;
+    switch (id) {
+        case SfxId::PLAYER_HIT:
+            duration = 0.12f;
+            break;
+        case SfxId::BOMB_PICKUP:
+            duration = 0.2f;
+            break;
+        case SfxId::BOSS_HIT:
+            duration = 0.4f;
+            break;
+        case SfxId::COUNT:
+            break;
+    }
+
+    pcm.resize(static_cast<size_t>(duration * SAMPLE_RATE));
+    float phase = 0.f;
+    for (size_t n = 0; n < pcm.size(); ++n) {
+        const float t = static_cast<float>(n) / SAMPLE_RATE;
+        const float progress = t / duration;
+        float sample = 0.f;
+
+        switch (id) {
+            case SfxId::PLAYER_HIT: {
+                // short noisy thud falling from 220 to 110 Hz
+                phase += TWO_PI * (220.f - 110.f * progress) / SAMPLE_RATE;
+                const float envelope = (1.f - progress) * (1.f - progress);
+                sample = (0.5f * std::sin(phase) + 0.4f * noise()) * envelope;
+                break;
+            }
+            case SfxId::BOMB_PICKUP: {
+                // two note square chime
+                phase += TWO_PI * (progress < 0.4f ? 660.f : 990.f) / SAMPLE_RATE;
+                sample = (std::sin(phase) >= 0.f ? 0.3f : -0.3f) * (1.f - progress);
+                break;
+            }
+            case SfxId::BOSS_HIT: {
+                // low boom sweeping down with a noise crack at the start
+                phase += TWO_PI * (90.f - 50.f * progress) / SAMPLE_RATE;
+                const float crack = t < 0.08f ? noise() * (1.f - t / 0.08f) : 0.f;
+                sample = (0.8f * std::sin(phase) + 0.4f * crack) * std::exp(-5.f * progress);
+                break;
+            }
+            case SfxId::COUNT:
+                break;
+        }
+
+        pcm[n] = static_cast<int16_t>(std::clamp(sample, -1.f, 1.f) * 32767.f);
+    }
+}
@@ -0,0 +1,52 @@
+#include "Survival.hpp"
+
+#include "Game.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+bool Survival::enabled = false;
+size_t Survival::live = 0;
+size_t Survival::peak = 0;
+
+namespace {
+constexpr float MIN_ATTACK_INTERVAL = 0.05f;
+constexpr int MAX_ATTACKS_PER_WAVE = 32;
+constexpr int MAX_BULLET_REPEAT = 16;
+// a little slack so a 60 Hz vsync frame that was a bit late still counts
+constexpr float SIXTY_FPS_FRAME = 1.f / 60.f * 1.1f;
+} // namespace
+
+void Survival::reset()
+{
+    live = 0;
+    peak = 0;
+}
+
+void Survival::recordFrame(float frameTime, size_t entities)
+{
+    live = entities;
+    if (frameTime <= SIXTY_FPS_FRAME)
+        peak = std::max(peak, entities);
+}
+
+int Survival::level()
+{
+    return static_cast<int>(Game::gameTime / SURVIVAL_LEVEL_SECONDS);
+}
+
+float Survival::attackInterval()
+{
+    // HARD spawns every 0.5 s, each level is 15% faster
+    return std::max(MIN_ATTACK_INTERVAL, 0.5f * std::pow(0.85f, static_cast<float>(level())));
+}
+
+int Survival::attacksPerWave()
+{
+    return std::min(1 + level(), MAX_ATTACKS_PER_WAVE);
+}
+
+int Survival::bulletRepeat()
+{
+    return enabled ? std::min(1 + level() / 2, MAX_BULLET_REPEAT) : 1;
+}
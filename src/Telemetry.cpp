@@ -0,0 +1,116 @@
+#include "Telemetry.hpp"
+
+#include "Difficulty.hpp"
+#include "Settings.hpp"
+#include "raylib.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+std::array<uint32_t, Telemetry::HISTOGRAM_BUCKETS> Telemetry::histogram{};
+std::array<Telemetry::Hitch, TELEMETRY_HITCH_COUNT> Telemetry::hitches{};
+uint32_t Telemetry::frameCount = 0;
+float Telemetry::maxFrameTime = 0.f;
+size_t Telemetry::peakBullets = 0;
+size_t Telemetry::peakAttacks = 0;
+size_t Telemetry::peakBombs = 0;
+
+void Telemetry::reset()
+{
+    histogram.fill(0);
+    hitches.fill({});
+    frameCount = 0;
+    maxFrameTime = 0.f;
+    peakBullets = 0;
+    peakAttacks = 0;
+    peakBombs = 0;
+}
+
+void Telemetry::recordFrame(float frameTime,
+                            float gameTime,
+                            size_t bullets,
+                            size_t attacks,
+                            size_t bombs)
+{
+    const float ms = frameTime * 1000.f;
+    const auto bucket = static_cast<size_t>(std::max(ms, 0.f) / BUCKET_MS);
+    ++histogram[std::min(bucket, HISTOGRAM_BUCKETS - 1)];
+    ++frameCount;
+    maxFrameTime = std::max(maxFrameTime, ms);
+
+    // keep the slowest frames sorted, the list is tiny so an insertion is enough
+    if (ms > hitches.back().frameTime) {
+        auto it = std::ranges::find_if(hitches, [ms](const Hitch &h) { return ms > h.frameTime; });
+        std::shift_right(it, hitches.end(), 1);
+        *it = {ms, gameTime};
+    }
+
+    peakBullets = std::max(peakBullets, bullets);
+    peakAttacks = std::max(peakAttacks, attacks);
+    peakBombs = std::max(peakBombs, bombs);
+}
+
+float Telemetry::percentile(float fraction)
+{
+    if (frameCount == 0)
+        return 0.f;
+
+    const auto target = static_cast<uint32_t>(fraction * (frameCount - 1));
+    uint32_t seen = 0;
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+        seen += histogram[i];
+        if (seen > target)
+            return (i + 0.5f) * BUCKET_MS; // bucket center
+    }
+    return maxFrameTime;
+}
+
+void Telemetry::endRun(RunResult result, RunMode mode, float gameTime)
+{
+    constexpr auto clamp16 = [](size_t value) {
+        return static_cast<uint16_t>(std::min<size_t>(value, std::numeric_limits<uint16_t>::max()));
+    };
+
+    TelemetryRecord record{};
+    record.magic = TELEMETRY_MAGIC;
+    record.version = TELEMETRY_VERSION;
+    record.size = sizeof(TelemetryRecord);
+    record.timestamp = std::chrono::duration_cast<std::chrono::seconds>(
+                           std::chrono::system_clock::now().time_since_epoch())
+                           .count();
+    record.gameTime = gameTime;
+    record.frameCount = frameCount;
+    record.frameTimeP50 = percentile(0.50f);
+    record.frameTimeP90 = percentile(0.90f);
+    record.frameTimeP99 = percentile(0.99f);
+    record.frameTimeMax = maxFrameTime;
+    for (size_t i = 0; i < TELEMETRY_HITCH_COUNT; ++i) {
+        record.hitchFrameTime[i] = hitches[i].frameTime;
+        record.hitchGameTime[i] = hitches[i].gameTime;
+    }
+    record.peakBullets = static_cast<uint32_t>(std::min<size_t>(peakBullets, UINT32_MAX));
+    record.peakAttacks = clamp16(peakAttacks);
+    record.peakBombs = clamp16(peakBombs);
+    record.targetFPS = Settings::config.targetFPS;
+    record.difficulty = static_cast<uint8_t>(currentDifficulty);
+    record.result = static_cast<uint8_t>(result);
+    record.vsync = Settings::config.vsync;
+    record.mode = static_cast<uint8_t>(mode);
+
+    const std::string path = Settings::getConfigPath(TELEMETRY_FILE_NAME);
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+
+    std::ofstream file(path, std::ios::binary | std::ios::app);
+    if (!file.is_open()) {
+        TraceLog(LOG_WARNING, "Failed to open telemetry file for writing: %s", path.c_str());
+        return;
+    }
+    file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+
+    TraceLog(LOG_INFO, "Run telemetry: %u frames, p50 %.1f ms, p99 %.1f ms, max %.1f ms",
+             record.frameCount, record.frameTimeP50, record.frameTimeP99, record.frameTimeMax);
+}
@@ -0,0 +1,168 @@
+#include "TimerWheel.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+std::vector<TimerWheel::Timer> TimerWheel::timers{};
+std::vector<uint32_t> TimerWheel::freeTimers{};
+std::vector<uint32_t> TimerWheel::expired{};
+uint32_t TimerWheel::slots[LEVELS][SLOTS] = {};
+uint32_t TimerWheel::currentTick = 0;
+uint32_t TimerWheel::nextSequence = 0;
+
+namespace {
+uint32_t toTicks(float seconds)
+{
+    return static_cast<uint32_t>(std::lround(std::fmax(seconds, 0.f) * TIMER_TICKS_PER_SECOND));
+}
+} // namespace
+
+TimerId TimerWheel::schedule(float delay, Callback callback, void *context)
+{
+    // never on the current tick, it was already processed
+    return scheduleAt({currentTick + std::max(toTicks(delay), 1u), nextSequence++}, callback,
+                      context);
+}
+
+TimerId TimerWheel::scheduleAt(TimerDue due, Callback callback, void *context)
+{
+    if (timers.empty()) {
+        for (auto &level : slots)
+            std::fill(std::begin(level), std::end(level), NONE); // they start out as 0
+    }
+
+    uint32_t index;
+    if (freeTimers.empty()) {
+        index = static_cast<uint32_t>(timers.size());
+        timers.push_back({});
+    } else {
+        index = freeTimers.back();
+        freeTimers.pop_back();
+    }
+
+    Timer &timer = timers[index];
+    timer.due = std::max(due.tick, currentTick + 1);
+    timer.sequence = due.sequence;
+    timer.cancelled = false;
+    timer.callback = callback;
+    timer.context = context;
+    insert(index);
+
+    return {index, timer.generation};
+}
+
+TimerDue TimerWheel::due(TimerId id)
+{
+    if (id.index >= timers.size() || timers[id.index].generation != id.generation ||
+        timers[id.index].cancelled)
+        return {};
+    return {timers[id.index].due, timers[id.index].sequence};
+}
+
+void TimerWheel::cancel(TimerId id)
+{
+    // the timer stays linked until its slot comes up, then it's released without firing
+    if (id.index < timers.size() && timers[id.index].generation == id.generation)
+        timers[id.index].cancelled = true;
+}
+
+void TimerWheel::advance(float gameTime)
+{
+    const uint32_t target = toTicks(gameTime);
+    if (timers.empty()) {
+        currentTick = target; // nothing was ever scheduled, the slots aren't set up yet
+        return;
+    }
+
+    while (currentTick < target) {
+        ++currentTick;
+
+        // when a level wraps, the next slot of the level above is spread over the ones below
+        for (uint32_t level = 1; level < LEVELS; ++level) {
+            if ((currentTick & ((1u << (SLOT_BITS * level)) - 1)) != 0)
+                break;
+            cascade(level);
+        }
+
+        uint32_t &slot = slots[0][currentTick & (SLOTS - 1)];
+        for (uint32_t index = slot; index != NONE; index = timers[index].next)
+            expired.push_back(index);
+        slot = NONE;
+    }
+
+    // the slots hold their timers in no useful order, the callbacks must not depend on it
+    std::sort(expired.begin(), expired.end(), [](uint32_t a, uint32_t b) {
+        return timers[a].due != timers[b].due ? timers[a].due < timers[b].due
+                                              : timers[a].sequence < timers[b].sequence;
+    });
+
+    // callbacks may schedule or cancel (not clear), everything is already unlinked
+    for (const uint32_t index : expired) {
+        const Timer timer = timers[index];
+        release(index);
+        if (!timer.cancelled)
+            timer.callback(timer.context);
+    }
+    expired.clear();
+}
+
+void TimerWheel::clear()
+{
+    for (auto &level : slots)
+        std::fill(std::begin(level), std::end(level), NONE);
+
+    freeTimers.clear();
+    for (uint32_t i = 0; i < timers.size(); ++i) {
+        ++timers[i].generation; // ids handed out before are dead now
+        freeTimers.push_back(i);
+    }
+    currentTick = 0;
+    nextSequence = 0;
+}
+
+void TimerWheel::restore(uint32_t tick, uint32_t sequence)
+{
+    clear();
+    currentTick = tick;
+    nextSequence = sequence;
+}
+
+void TimerWheel::insert(uint32_t index)
+{
+    Timer &timer = timers[index];
+    const uint32_t delta = timer.due - currentTick;
+
+    uint32_t level = 0;
+    while (level < LEVELS - 1 && delta >= (1u << (SLOT_BITS * (level + 1))))
+        ++level;
+
+    // a delay past the top level waits in its furthest slot and is placed again from there
+    const uint32_t span = 1u << (SLOT_BITS * LEVELS);
+    const uint32_t due = delta < span ? timer.due : currentTick + span - 1;
+
+    uint32_t &slot = slots[level][(due >> (SLOT_BITS * level)) & (SLOTS - 1)];
+    timer.next = slot;
+    slot = index;
+}
+
+void TimerWheel::cascade(uint32_t level)
+{
+    uint32_t &slot = slots[level][(currentTick >> (SLOT_BITS * level)) & (SLOTS - 1)];
+    uint32_t index = slot;
+    slot = NONE;
+
+    while (index != NONE) {
+        const uint32_t next = timers[index].next;
+        if (timers[index].cancelled)
+            release(index);
+        else
+            insert(index); // a timer due on this tick lands in the slot processed next
+        index = next;
+    }
+}
+
+void TimerWheel::release(uint32_t index)
+{
+    ++timers[index].generation;
+    freeTimers.push_back(index);
+}
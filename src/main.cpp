@@ -1,15 +1,150 @@
+#include "AllocTracker.hpp"
+#include "Benchmark.hpp"
+#include "FrameCapture.hpp"
 #include "Game.hpp"
+#include "HitchDetector.hpp"
+#include "MusicCache.hpp"
+#include "Netplay.hpp"
+#include "Profiler.hpp"
+#include "Replay.hpp"
+#include "SamplingProfiler.hpp"
+#include "Settings.hpp"
+
+#include <cstdlib>
+#include <string_view>
 
 Game game;
 
-int main()
+int main(int argc, char **argv)
 {
+    const char *tracePath = nullptr;
+    float traceSeconds = TRACE_DEFAULT_SECONDS;
+    float hitchFactor = HITCH_DEFAULT_FACTOR;
+    const char *capturePath = nullptr;
+    int captureFps = CAPTURE_DEFAULT_FPS;
+    int netDelay = 0;
+    int netLoss = 0;
+#ifdef SAMPLING_PROFILER
+    std::string profilePath;
+    int profileHz = PROFILE_DEFAULT_HZ;
+#endif
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--benchmark") {
+            // the frame count is optional
+            int frames = BENCHMARK_DEFAULT_FRAMES;
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                frames = static_cast<int>(std::strtol(argv[++i], nullptr, 10));
+            Benchmark::start(frames);
+            continue;
+        }
+        if (arg == "--no-music-cache") {
+            MusicCache::setEnabled(false);
+            continue;
+        }
+        if (arg == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+            continue;
+        }
+        if (arg == "--trace-seconds" && i + 1 < argc) {
+            traceSeconds = std::strtof(argv[++i], nullptr);
+            continue;
+        }
+        if (arg == "--capture" && i + 1 < argc) {
+            // a file, or "|command" to pipe into an encoder
+            capturePath = argv[++i];
+            continue;
+        }
+        if (arg == "--capture-fps" && i + 1 < argc) {
+            captureFps = static_cast<int>(std::strtol(argv[++i], nullptr, 10));
+            continue;
+        }
+        if (arg == "--replay" && i + 1 < argc) {
+            // plays the file instead of the main menu
+            ReplayPlayback::open(argv[++i]);
+            continue;
+        }
+        if (arg == "--host") {
+            // the port is optional
+            auto port = static_cast<uint16_t>(NET_DEFAULT_PORT);
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                port = static_cast<uint16_t>(std::strtoul(argv[++i], nullptr, 10));
+            Netplay::host(port);
+            continue;
+        }
+        if (arg == "--join" && i + 1 < argc) {
+            Netplay::join(argv[++i]);
+            continue;
+        }
+        if (arg == "--net-delay" && i + 1 < argc) {
+            netDelay = static_cast<int>(std::strtol(argv[++i], nullptr, 10));
+            continue;
+        }
+        if (arg == "--net-loss" && i + 1 < argc) {
+            netLoss = static_cast<int>(std::strtol(argv[++i], nullptr, 10));
+            continue;
+        }
+        if (arg == "--hitch-factor" && i + 1 < argc) {
+            hitchFactor = std::strtof(argv[++i], nullptr);
+            continue;
+        }
+#ifdef SAMPLING_PROFILER
+        if (arg == "--profile" && i + 1 < argc) {
+            profilePath = argv[++i];
+            continue;
+        }
+        if (arg == "--profile-hz" && i + 1 < argc) {
+            profileHz = static_cast<int>(std::strtol(argv[++i], nullptr, 10));
+            continue;
+        }
+#endif
+#ifdef ALLOC_TRACKING
+        if (arg == "--alloc-budget" && i + 1 < argc) {
+            AllocTracker::setBudget(static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)));
+            continue;
+        }
+#endif
+        TraceLog(LOG_WARNING, "Unknown argument: %s", argv[i]);
+    }
+
+    Netplay::setShim(netDelay, netLoss);
+
+    // counts TraceLog lines from here on, the arguments above are logged the usual way
+    HitchDetector::init(hitchFactor);
+
+    // started before init so asset loading shows up in the trace
+    Profiler::setThreadName("main");
+    if (tracePath)
+        Profiler::start(tracePath, traceSeconds);
+
     game.init();
+    // the pixel buffers need the GL context
+    if (capturePath)
+        FrameCapture::start(capturePath, captureFps);
+
+#ifdef SAMPLING_PROFILER
+    // samples are only taken while PLAYING, see Game::updateFrame
+    SamplingProfiler::init(
+        profilePath.empty() ? Settings::getConfigPath(PROFILE_FILE_NAME) : profilePath, profileHz);
+#endif
 
     while (!game.shouldClose && !WindowShouldClose())
         game.updateFrame();
 
     game.cleanup();
     CloseWindow();
+
+    // write out a capture that was still running when the game closed
+    Profiler::stop();
+#ifdef SAMPLING_PROFILER
+    SamplingProfiler::shutdown();
+#endif
+
+#ifdef ALLOC_TRACKING
+    // lets benchmark runs fail when a gameplay frame went over the budget
+    if (AllocTracker::budgetExceeded())
+        return EXIT_FAILURE;
+#endif
     return 0;
 }
@@ -0,0 +1,114 @@
+// resolves the game frames of a folded profile written by the sampling profiler
+// usage: symbolize bombkurdistan.sym profile.folded > symbolized.folded
+// the .sym sidecar is the `nm -n -C --defined-only` output of the unstripped binary,
+// generated next to the binary by builds with the SAMPLING_PROFILER option
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+struct Symbol
+{
+    uint64_t address;
+    std::string name;
+};
+
+bool parseHex(std::string_view text, uint64_t &value)
+{
+    const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value, 16);
+    return ec == std::errc() && ptr == text.data() + text.size();
+}
+
+// only code symbols, sorted by address as nm -n prints them
+std::vector<Symbol> loadSymbols(std::ifstream &file)
+{
+    std::vector<Symbol> symbols;
+    std::string line;
+    while (std::getline(file, line)) {
+        // "<address> <type> <name>", the demangled name may contain spaces
+        const size_t typePos = line.find(' ');
+        if (typePos == std::string::npos || typePos + 3 > line.size())
+            continue;
+        const char type = line[typePos + 1];
+        if (type != 't' && type != 'T' && type != 'w' && type != 'W')
+            continue;
+
+        uint64_t address = 0;
+        if (parseHex(std::string_view(line).substr(0, typePos), address))
+            symbols.push_back({address, line.substr(typePos + 3)});
+    }
+    std::ranges::sort(symbols, {}, &Symbol::address);
+    return symbols;
+}
+
+std::string_view resolve(const std::vector<Symbol> &symbols, std::string_view frame)
+{
+    uint64_t address = 0;
+    if (!frame.starts_with("0x") || !parseHex(frame.substr(2), address))
+        return frame; // already named (shared library) or unknown
+
+    const auto it = std::ranges::upper_bound(symbols, address, {}, &Symbol::address);
+    if (it == symbols.begin())
+        return frame;
+    return std::prev(it)->name;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc != 3) {
+        std::cerr << "usage: " << argv[0] << " <bombkurdistan.sym> <profile.folded>\n";
+        return 1;
+    }
+
+    std::ifstream symbolFile(argv[1]);
+    std::ifstream profileFile(argv[2]);
+    if (!symbolFile.is_open() || !profileFile.is_open()) {
+        std::cerr << "could not open " << (symbolFile.is_open() ? argv[2] : argv[1]) << '\n';
+        return 1;
+    }
+
+    const std::vector<Symbol> symbols = loadSymbols(symbolFile);
+    if (symbols.empty()) {
+        std::cerr << "no code symbols in " << argv[1] << '\n';
+        return 1;
+    }
+
+    // several return addresses map to the same function, so stacks are merged again
+    std::map<std::string, uint64_t> folded;
+    std::string line;
+    while (std::getline(profileFile, line)) {
+        const size_t countPos = line.rfind(' ');
+        if (countPos == std::string::npos)
+            continue;
+        uint64_t count = 0;
+        const std::string_view countText = std::string_view(line).substr(countPos + 1);
+        if (std::from_chars(countText.data(), countText.data() + countText.size(), count).ec !=
+            std::errc())
+            continue;
+
+        std::string stack;
+        std::string_view frames = std::string_view(line).substr(0, countPos);
+        while (!frames.empty()) {
+            const size_t end = frames.find(';');
+            if (!stack.empty())
+                stack.push_back(';');
+            // folded stacks use ';' as the separator, templates never contain it
+            stack.append(resolve(symbols, frames.substr(0, end)));
+            frames = end == std::string_view::npos ? std::string_view() : frames.substr(end + 1);
+        }
+        folded[stack] += count;
+    }
+
+    for (const auto &[stack, count] : folded)
+        std::cout << stack << ' ' << count << '\n';
+    return 0;
+}
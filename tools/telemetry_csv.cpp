@@ -0,0 +1,85 @@
+// exports the run records of telemetry.bin as CSV
+// usage: telemetry_csv ~/.config/BombKurdistan/telemetry.bin > runs.csv
+
+#include "TelemetryRecord.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+constexpr const char *DIFFICULTY_NAMES[] = {"easy", "normal", "hard"};
+constexpr const char *RESULT_NAMES[] = {"game_over", "win"};
+constexpr const char *MODE_NAMES[] = {"normal", "survival"};
+constexpr uint16_t FIRST_VERSION = 1; // same layout, the mode byte was still reserved
+
+template <size_t N> const char *nameOf(const char *const (&names)[N], uint8_t index)
+{
+    return index < N ? names[index] : "unknown";
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc != 2) {
+        std::cerr << "usage: " << argv[0] << " <telemetry.bin>\n";
+        return 1;
+    }
+
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "could not open " << argv[1] << '\n';
+        return 1;
+    }
+
+    std::cout << "timestamp,result,difficulty,mode,game_time,frames,p50_ms,p90_ms,p99_ms,max_ms,"
+                 "peak_bullets,peak_attacks,peak_bombs,vsync,target_fps";
+    for (int i = 1; i <= TELEMETRY_HITCH_COUNT; ++i)
+        std::cout << ",hitch" << i << "_ms,hitch" << i << "_at";
+    std::cout << '\n';
+
+    // the common header tells the record size, so records of newer versions can be skipped
+    constexpr size_t HEADER_SIZE = offsetof(TelemetryRecord, timestamp);
+    std::vector<char> buffer;
+    size_t skipped = 0;
+    for (;;) {
+        TelemetryRecord record{};
+        if (!file.read(reinterpret_cast<char *>(&record), HEADER_SIZE))
+            break;
+        if (record.magic != TELEMETRY_MAGIC || record.size < HEADER_SIZE) {
+            std::cerr << "corrupt record, stopping\n";
+            return 1;
+        }
+
+        buffer.resize(record.size - HEADER_SIZE);
+        if (!file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()))) {
+            std::cerr << "truncated record, stopping\n";
+            break;
+        }
+        if (record.version < FIRST_VERSION || record.version > TELEMETRY_VERSION ||
+            record.size != sizeof(TelemetryRecord)) {
+            ++skipped;
+            continue;
+        }
+        std::memcpy(reinterpret_cast<char *>(&record) + HEADER_SIZE, buffer.data(),
+                    buffer.size());
+
+        std::cout << record.timestamp << ',' << nameOf(RESULT_NAMES, record.result) << ','
+                  << nameOf(DIFFICULTY_NAMES, record.difficulty) << ','
+                  << (record.version >= 2 ? nameOf(MODE_NAMES, record.mode) : "unknown") << ','
+                  << record.gameTime << ','
+                  << record.frameCount << ',' << record.frameTimeP50 << ',' << record.frameTimeP90
+                  << ',' << record.frameTimeP99 << ',' << record.frameTimeMax << ','
+                  << record.peakBullets << ',' << record.peakAttacks << ',' << record.peakBombs
+                  << ',' << static_cast<int>(record.vsync) << ',' << record.targetFPS;
+        for (int i = 0; i < TELEMETRY_HITCH_COUNT; ++i)
+            std::cout << ',' << record.hitchFrameTime[i] << ',' << record.hitchGameTime[i];
+        std::cout << '\n';
+    }
+
+    if (skipped > 0)
+        std::cerr << "skipped " << skipped << " records of an unknown version\n";
+    return 0;
+}